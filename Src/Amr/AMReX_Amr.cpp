@@ -7,6 +7,7 @@
 #include <iomanip>
 #include <limits>
 #include <cmath>
+#include <numeric>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -33,6 +34,8 @@
 #include <AMReX_DistributionMapping.H>
 #include <AMReX_FabSet.H>
 #include <AMReX_StateData.H>
+#include <AMReX_FabCompress.H>
+#include <AMReX_NFiles.H>
 #include <AMReX_PlotFileUtil.H>
 #include <AMReX_Print.H>
 
@@ -119,6 +122,7 @@ namespace
     int  compute_new_dt_on_regrid;
     bool precreateDirectories;
     bool prereadFAHeaders;
+    bool async_output;
     VisMF::Header::Version plot_headerversion(VisMF::Header::Version_v1);
     VisMF::Header::Version checkpoint_headerversion(VisMF::Header::Version_v1);
 //}
@@ -154,6 +158,7 @@ Amr::Initialize ()
     compute_new_dt_on_regrid = 0;
     precreateDirectories     = true;
     prereadFAHeaders         = true;
+    async_output             = false;
     plot_headerversion       = VisMF::Header::Version_v1;
     checkpoint_headerversion = VisMF::Header::Version_v1;
 #ifdef BL_USE_SENSEI_INSITU
@@ -517,6 +522,22 @@ Amr::InitAmr ()
 
     loadbalance_max_fac = 1.5;
     pp.query("loadbalance_max_fac", loadbalance_max_fac);
+
+    dynamic_lb_int = 0;
+    pp.query("dynamic_lb_int", dynamic_lb_int);
+
+    dynamic_lb_threshold = 0.1;
+    pp.query("dynamic_lb_threshold", dynamic_lb_threshold);
+
+    dynamic_lb_strategy = "KNAPSACK";
+    pp.query("dynamic_lb_strategy", dynamic_lb_strategy);
+    if (dynamic_lb_strategy != "KNAPSACK" && dynamic_lb_strategy != "SFC" &&
+        dynamic_lb_strategy != "GRAPH") {
+        amrex::Abort("Amr: unknown amr.dynamic_lb_strategy " + dynamic_lb_strategy);
+    }
+
+    // ---- unknown until the first remap is timed
+    dynamic_lb_remap_time = -1.0;
 }
 
 int
@@ -758,6 +779,8 @@ Amr::deleteDeriveSmallPlotVar (const std::string& name)
 
 Amr::~Amr ()
 {
+    FinishAsyncOutput();
+
     levelbld->variableCleanUp();
 
     Amr::Finalize();
@@ -875,6 +898,8 @@ Amr::writePlotFile ()
     BL_PROFILE_REGION_START("Amr::writePlotFile()");
     BL_PROFILE("Amr::writePlotFile()");
 
+    FinishAsyncOutput();
+
     VisMF::SetNOutFiles(plot_nfiles);
     VisMF::Header::Version currentVersion(VisMF::GetHeaderVersion());
     VisMF::SetHeaderVersion(plot_headerversion);
@@ -929,6 +954,8 @@ Amr::writePlotFile ()
       amrex::UtilCreateCleanDirectory(pltfileTemp, true);  // call barrier
     }
 
+    VisMF::SetAsyncWrite(async_output);
+
     std::string HeaderFileName(pltfileTemp + "/Header");
 
     VisMF::IO_Buffer io_buffer(VisMF::GetIOBufferSize());
@@ -980,6 +1007,15 @@ Amr::writePlotFile ()
 
 	amrex::Print() << "Write plotfile time = " << dPlotFileTime << "  seconds" << "\n\n";
     }
+    if (async_output) {
+      //
+      // the FAB data is still being written, FinishAsyncOutput
+      // does the rename once it is done
+      //
+      pending_output_renames.push_back(std::make_pair(pltfileTemp, pltfile));
+      break;
+    }
+
     ParallelDescriptor::Barrier("Amr::writePlotFile::end");
 
     if(ParallelDescriptor::IOProcessor()) {
@@ -992,6 +1028,7 @@ Amr::writePlotFile ()
 
   }  // end while
 
+  VisMF::SetAsyncWrite(false);
   VisMF::SetHeaderVersion(currentVersion);
   
   BL_PROFILE_REGION_STOP("Amr::writePlotFile()");
@@ -1471,6 +1508,14 @@ Amr::restart (const std::string& filename)
         runlog << "RESTART from file = " << filename << '\n';
     }
 
+    //
+    // A checkpoint that was not fully copied from the local tier yet
+    // is restored from there.
+    //
+    if (check_tier && check_tier->restore(filename, filename) && verbose > 0) {
+        amrex::Print() << "restored " << filename << " from the local checkpoint tier\n";
+    }
+
     // ---- preread and broadcast all FabArray headers if this file exists
     std::map<std::string, Vector<char> > faHeaderMap;
     if(prereadFAHeaders) {
@@ -1764,7 +1809,14 @@ Amr::checkPoint ()
     BL_PROFILE_REGION_START("Amr::checkPoint()");
     BL_PROFILE("Amr::checkPoint()");
 
-    VisMF::SetNOutFiles(checkpoint_nfiles);
+    FinishAsyncOutput();
+
+    //
+    // Every file in the local tier must have one writer, including the
+    // ones particle containers write through NFilesIter.
+    //
+    VisMF::SetNOutFiles(check_tier ? ParallelDescriptor::NProcs() : checkpoint_nfiles);
+    NFilesIter::SetFilePerProcess(check_tier != nullptr);
     //
     // In checkpoint files always write out FABs in NATIVE format.
     //
@@ -1774,6 +1826,11 @@ Amr::checkPoint ()
 
     VisMF::Header::Version currentVersion(VisMF::GetHeaderVersion());
     VisMF::SetHeaderVersion(checkpoint_headerversion);
+    //
+    // Checkpoints must restart bit for bit, so never quantize them.
+    //
+    int thePrevCodec = VisMF::GetCompressionCodec();
+    VisMF::SetCompressionCodec(FabCompress::Lossless);
 
     Real dCheckPointTime0 = amrex::second();
 
@@ -1788,10 +1845,29 @@ Amr::checkPoint ()
     }
 
 
-  amrex::StreamRetry sretry(ckfile, abort_on_stream_retry_failure,
+    if (check_base_int > 1)
+    {
+        const bool is_base = (checkpoints_since_base % check_base_int) == 0;
+        const std::size_t slash = ckfile.rfind('/');
+        StateData::SetCheckPointMode(is_base ? StateData::CheckPointMode::Base
+                                             : StateData::CheckPointMode::Delta,
+                                     slash == std::string::npos ? ckfile : ckfile.substr(slash+1));
+        if (verbose > 0 && ! is_base) {
+            amrex::Print() << "CHECKPOINT: incremental, "
+                           << checkpoints_since_base % check_base_int
+                           << " since the last full checkpoint\n";
+        }
+    }
+
+  //
+  // In the local tier every rank writes to its own directory.
+  //
+  const std::string ckdir = check_tier ? check_tier->dir(ckfile) : ckfile;
+
+  amrex::StreamRetry sretry(ckdir, abort_on_stream_retry_failure,
                              stream_max_tries);
 
-  const std::string ckfileTemp(ckfile + ".temp");
+  const std::string ckfileTemp(ckdir + ".temp");
 
   while(sretry.TryFileOutput()) {
 
@@ -1805,7 +1881,19 @@ Amr::checkPoint ()
     //  it to a bad suffix if there were stream errors.
     //
 
-    if (precreateDirectories) {    // ---- make all directories at once
+    if (check_tier) {
+      check_tier->prepare(ckfile);
+      for (int i(0); i <= finest_level; ++i)
+      {
+        std::string LevelDir, FullPath;
+        amr_level[i]->LevelDirectoryNames(ckfileTemp, LevelDir, FullPath);
+        if ( ! amrex::UtilCreateDirectory(FullPath, 0755)) {
+          amrex::CreateDirectoryFailed(FullPath);
+        }
+        amr_level[i]->CreateLevelDirectory(ckfileTemp);
+      }
+      ParallelDescriptor::Barrier("Amr::checkPoint::localDirectories");
+    } else if (precreateDirectories) {    // ---- make all directories at once
       amrex::UtilRenameDirectoryToOld(ckfile, false);      // dont call barrier
       amrex::UtilCreateCleanDirectory(ckfileTemp, false);  // dont call barrier
       for (int i(0); i <= finest_level; ++i) 
@@ -1818,6 +1906,8 @@ Amr::checkPoint ()
       amrex::UtilCreateCleanDirectory(ckfileTemp, true);  // call barrier
     }
 
+    VisMF::SetAsyncWrite(async_output && ! check_tier);
+
     std::string HeaderFileName = ckfileTemp + "/Header";
 
     VisMF::IO_Buffer io_buffer(VisMF::GetIOBufferSize());
@@ -1914,25 +2004,91 @@ Amr::checkPoint ()
 
 	amrex::Print() << "checkPoint() time = " << dCheckPointTime << " secs." << '\n';
     }
+    if (async_output && ! check_tier) {
+      pending_output_renames.push_back(std::make_pair(ckfileTemp, ckfile));
+      break;
+    }
+
     ParallelDescriptor::Barrier("Amr::checkPoint::end");
 
-    if(ParallelDescriptor::IOProcessor()) {
-      std::rename(ckfileTemp.c_str(), ckfile.c_str());
+    if (check_tier) {
+      check_tier->commit(ckfile);
+    } else {
+      if(ParallelDescriptor::IOProcessor()) {
+        std::rename(ckfileTemp.c_str(), ckfile.c_str());
+      }
+      ParallelDescriptor::Barrier("Renaming temporary checkPoint file.");
     }
-    ParallelDescriptor::Barrier("Renaming temporary checkPoint file.");
 
   }  // end while
 
+  //
+  // The copy to the shared checkpoint is finished by FinishAsyncOutput.
+  //
+  if (check_tier) {
+    check_tier->drain(ckfile, ckfile);
+    pending_output_renames.push_back(std::make_pair(ckfile + ".temp", ckfile));
+  }
+
+  if (check_base_int > 1) {
+      ++checkpoints_since_base;
+      StateData::SetCheckPointMode(StateData::CheckPointMode::Full);
+  }
+
+  VisMF::SetAsyncWrite(false);
+  NFilesIter::SetFilePerProcess(false);
   //
   // Restore the previous FAB format.
   //
   FArrayBox::setFormat(thePrevFormat);
 
   VisMF::SetHeaderVersion(currentVersion);
+  VisMF::SetCompressionCodec(thePrevCodec);
 
   BL_PROFILE_REGION_STOP("Amr::checkPoint()");
 }
 
+void
+Amr::FinishAsyncOutput ()
+{
+    //
+    // pending_output_renames is the same on all processors.
+    //
+    if (pending_output_renames.empty()) {
+      return;
+    }
+
+    BL_PROFILE("Amr::FinishAsyncOutput()");
+
+    Real dWaitTime0 = amrex::second();
+
+    VisMF::FinishAsyncWrites();
+
+    if (check_tier) {
+        check_tier->finishDrain();
+    }
+
+    ParallelDescriptor::Barrier("Amr::FinishAsyncOutput");
+
+    if(ParallelDescriptor::IOProcessor()) {
+      for (const auto& names : pending_output_renames) {
+        std::rename(names.first.c_str(), names.second.c_str());
+      }
+    }
+    ParallelDescriptor::Barrier("Renaming temporary async output files.");
+
+    pending_output_renames.clear();
+
+    if (verbose > 0) {
+        Real dWaitTime = amrex::second() - dWaitTime0;
+
+        ParallelDescriptor::ReduceRealMax(dWaitTime,
+                                    ParallelDescriptor::IOProcessorNumber());
+
+        amrex::Print() << "Async output wait time = " << dWaitTime << " secs." << '\n';
+    }
+}
+
 void
 Amr::RegridOnly (Real time, bool do_io)
 {
@@ -2110,6 +2266,7 @@ Amr::timeStep (int  level,
 
     BL_PROFILE_REGION_START("amr_level.advance");
     Real dt_new = amr_level[level]->advance(time,dt_level[level],iteration,niter);
+    amr_level[level]->cost_steps++;
     BL_PROFILE_REGION_STOP("amr_level.advance");
 
 #if defined(USE_PERILLA_PTHREADS) || defined(USE_PERILLA_OMP)
@@ -2440,6 +2597,12 @@ Amr::coarseTimeStep (Real stop_time)
 
     amr_level[0]->postCoarseTimeStep(cumtime);
 
+    if (dynamic_lb_int > 0 && level_steps[0] % dynamic_lb_int == 0) {
+        Real step_time = amrex::second() - run_strt;
+        ParallelDescriptor::ReduceRealMax(step_time);
+        DynamicLoadBalance(cumtime, step_time);
+    }
+
 
     if (verbose > 0)
     {
@@ -3081,6 +3244,101 @@ Amr::LoadBalanceLevel0 (Real time)
     amr_level[0]->post_regrid(0,time);
 }
 
+void
+Amr::DynamicLoadBalance (Real time, Real step_time)
+{
+    BL_PROFILE("Amr::DynamicLoadBalance()");
+
+    const int nprocs = ParallelDescriptor::NProcs();
+
+    Vector<DistributionMapping> newdm(finest_level+1);
+    bool remap = false;
+    Real gain = 0.0;  // predicted time saved before the next check
+    int  steps_per_coarse_step = 1;
+
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        steps_per_coarse_step *= n_cycle[lev];
+
+        AmrLevel& amrlev = *amr_level[lev];
+        if (amrlev.cost_steps == 0) continue;
+
+        const BoxArray& ba = boxArray(lev);
+        const DistributionMapping& dm = DistributionMap(lev);
+        const LayoutData<Real>& costs = amrlev.costs;
+
+        Vector<Real> cost(ba.size(), 0.0);
+        for (MFIter mfi(costs); mfi.isValid(); ++mfi) {
+            cost[mfi.index()] = costs[mfi];
+        }
+        ParallelDescriptor::ReduceRealSum(cost.dataPtr(), cost.size());
+
+        const Real total = std::accumulate(cost.begin(), cost.end(), Real(0.0));
+        if (total <= 0.0) continue;
+
+        DistributionMapping dmtmp;
+        if (dynamic_lb_strategy == "SFC") {
+            dmtmp = DistributionMapping::makeSFC(cost, ba);
+        } else if (dynamic_lb_strategy == "GRAPH") {
+            dmtmp = DistributionMapping::makeGraph(cost, ba, true, Geom(lev).periodicity());
+        } else {
+            dmtmp = DistributionMapping::makeKnapSack(cost);
+        }
+
+        Vector<Real> old_load(nprocs, 0.0), new_load(nprocs, 0.0);
+        for (int i = 0, N = ba.size(); i < N; ++i) {
+            old_load[dm[i]]    += cost[i];
+            new_load[dmtmp[i]] += cost[i];
+        }
+        const Real old_max = *std::max_element(old_load.begin(), old_load.end());
+        const Real new_max = *std::max_element(new_load.begin(), new_load.end());
+
+        if (verbose > 0) {
+            amrex::Print() << "DynamicLoadBalance: level " << lev
+                           << " efficiency " << total/(nprocs*old_max)
+                           << " -> " << total/(nprocs*new_max) << "\n";
+        }
+
+        if (new_max < (1.0-dynamic_lb_threshold)*old_max)
+        {
+            newdm[lev] = dmtmp;
+            remap = true;
+            gain += (old_max-new_max)/amrlev.cost_steps * steps_per_coarse_step * dynamic_lb_int;
+        }
+    }
+
+    // ---- until a remap has been timed, assume it costs as much as a
+    // ---- coarse step, as it moves all the state data like a regrid
+    const Real remap_time = (dynamic_lb_remap_time < 0.0) ? step_time : dynamic_lb_remap_time;
+
+    if (!remap || gain <= remap_time) {
+        return;
+    }
+
+    if (verbose > 0) {
+        amrex::Print() << "DynamicLoadBalance: rebalancing at t = " << time
+                       << ", predicted gain " << gain << " s\n";
+    }
+
+    const Real strt = amrex::second();
+
+    for (int lev = 0; lev <= finest_level; ++lev) {
+        if (newdm[lev].size() > 0) {
+            InstallNewDistributionMap(lev, newdm[lev]);
+        }
+    }
+    for (int lev = 0; lev <= finest_level; ++lev) {
+        amr_level[lev]->post_regrid(0,finest_level);
+    }
+
+    dynamic_lb_remap_time = amrex::second() - strt;
+    ParallelDescriptor::ReduceRealMax(dynamic_lb_remap_time);
+
+    if (verbose > 0) {
+        amrex::Print() << "DynamicLoadBalance: remap time " << dynamic_lb_remap_time << " s\n";
+    }
+}
+
 void
 Amr::InstallNewDistributionMap (int lev, const DistributionMapping& newdm)
 {
@@ -3509,12 +3767,35 @@ Amr::initPltAndChk ()
     check_per = -1.0;
     pp.query("check_per",check_per);
 
+    //
+    // With check_local_dir checkpoints are first written to node-local
+    // storage and copied to check_file in the background.
+    //
+    {
+        std::string check_local_dir;
+        pp.query("check_local_dir",check_local_dir);
+        int check_local_buddy = -1;
+        pp.query("check_local_buddy",check_local_buddy);
+        if ( ! check_local_dir.empty()) {
+            check_tier.reset(new CheckPointTier(check_local_dir, check_local_buddy));
+        }
+    }
+
     if (check_int > 0 && check_per > 0)
     {
         if (ParallelDescriptor::IOProcessor())
 	    amrex::Warning("Warning: both amr.check_int and amr.check_per are > 0.");
     }
 
+    //
+    // With check_base_int > 1 only every check_base_int-th checkpoint
+    // has all the state data; the ones in between only have the FABs
+    // that changed since then.
+    //
+    check_base_int = 0;
+    pp.query("check_base_int",check_base_int);
+    checkpoints_since_base = 0;
+
     plot_file_root = "plt";
     pp.query("plot_file",plot_file_root);
 
@@ -3563,6 +3844,7 @@ Amr::initPltAndChk ()
 
     pp.query("precreateDirectories", precreateDirectories);
     pp.query("prereadFAHeaders", prereadFAHeaders);
+    pp.query("async_output", async_output);
 
     int phvInt(plot_headerversion), chvInt(checkpoint_headerversion);
     pp.query("plot_headerversion", phvInt);
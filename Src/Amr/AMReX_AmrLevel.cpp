@@ -138,6 +138,8 @@ AmrLevel::AmrLevel (Amr&            papa,
                         *m_factory);
     }
 
+    costs.define(grids, dmap);
+
     if (parent->useFixedCoarseGrids()) constructAreaNotToTag();
 
     post_step_regrid = 0;
@@ -401,6 +403,8 @@ AmrLevel::restart (Amr&          papa,
     parent->SetBoxArray(level, grids);
     parent->SetDistributionMap(level, dmap);
 
+    costs.define(grids, dmap);
+
 #ifdef AMREX_USE_EB
     m_factory = makeEBFabFactory(geom, grids, dmap,
                                  {m_eb_basic_grow_cells, m_eb_volume_grow_cells, m_eb_full_grow_cells},
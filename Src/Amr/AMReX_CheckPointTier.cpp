@@ -0,0 +1,470 @@
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <algorithm>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <AMReX_CheckPointTier.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParallelReduce.H>
+#include <AMReX_Machine.H>
+#include <AMReX_Utility.H>
+#include <AMReX_Print.H>
+#include <AMReX_BLProfiler.H>
+
+namespace amrex {
+
+namespace {
+
+struct TreeEntry
+{
+    std::string name;  // ---- relative to the root of the tree
+    bool        isDir;
+};
+
+//
+// The files and directories under root/rel, parents before their contents.
+//
+void
+ListTree (const std::string& root, const std::string& rel, Vector<TreeEntry>& entries)
+{
+    const std::string path = rel.empty() ? root : root + '/' + rel;
+    DIR* d = opendir(path.c_str());
+    if (d == nullptr) {
+        amrex::Error("CheckPointTier: couldn't open directory " + path);
+    }
+    while (struct dirent* e = readdir(d))
+    {
+        if (std::strcmp(e->d_name, ".") == 0 || std::strcmp(e->d_name, "..") == 0) {
+            continue;
+        }
+        const std::string name = rel.empty() ? std::string(e->d_name) : rel + '/' + e->d_name;
+        struct stat st;
+        if (stat((root + '/' + name).c_str(), &st) != 0) {
+            amrex::Error("CheckPointTier: couldn't stat " + root + '/' + name);
+        }
+        const bool isDir = S_ISDIR(st.st_mode);
+        entries.push_back({name, isDir});
+        if (isDir) {
+            ListTree(root, name, entries);
+        }
+    }
+    closedir(d);
+}
+
+void
+RemoveTree (const std::string& path)
+{
+    struct stat st;
+    if (lstat(path.c_str(), &st) != 0) {
+        return;
+    }
+    if (S_ISDIR(st.st_mode))
+    {
+        Vector<TreeEntry> entries;
+        ListTree(path, std::string(), entries);
+        for (int i = entries.size()-1; i >= 0; --i) {
+            const std::string name = path + '/' + entries[i].name;
+            if (entries[i].isDir) {
+                rmdir(name.c_str());
+            } else {
+                std::remove(name.c_str());
+            }
+        }
+        rmdir(path.c_str());
+    }
+    else
+    {
+        std::remove(path.c_str());
+    }
+}
+
+long
+CopyFile (const std::string& src, const std::string& dst)
+{
+    std::ifstream ifs(src, std::ios::in | std::ios::binary);
+    std::ofstream ofs(dst, std::ios::out | std::ios::trunc | std::ios::binary);
+    if ( ! ifs.good()) {
+        amrex::FileOpenFailed(src);
+    }
+    if ( ! ofs.good()) {
+        amrex::FileOpenFailed(dst);
+    }
+    Vector<char> buf(1 << 20);
+    long nbytes = 0;
+    while (ifs.read(buf.data(), buf.size()) || ifs.gcount() > 0) {
+        ofs.write(buf.data(), ifs.gcount());
+        nbytes += ifs.gcount();
+    }
+    if ( ! ofs.good()) {
+        amrex::Error("CheckPointTier: couldn't write " + dst);
+    }
+    return nbytes;
+}
+
+//
+// Copies the tree src into the existing directory dst.  Directories that
+// another rank creates at the same time are fine.
+//
+long
+CopyTree (const std::string& src, const std::string& dst)
+{
+    Vector<TreeEntry> entries;
+    ListTree(src, std::string(), entries);
+    long nbytes = 0;
+    for (const auto& e : entries)
+    {
+        if (e.isDir) {
+            if ( ! amrex::UtilCreateDirectory(dst + '/' + e.name, 0755)) {
+                amrex::CreateDirectoryFailed(dst + '/' + e.name);
+            }
+        } else {
+            nbytes += CopyFile(src + '/' + e.name, dst + '/' + e.name);
+        }
+    }
+    return nbytes;
+}
+
+template <class T>
+void
+Append (Vector<char>& buf, const T& v)
+{
+    const std::size_t n = buf.size();
+    buf.resize(n + sizeof(T));
+    std::memcpy(buf.data() + n, &v, sizeof(T));
+}
+
+template <class T>
+T
+Extract (const Vector<char>& buf, std::size_t& pos)
+{
+    T v;
+    std::memcpy(&v, buf.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return v;
+}
+
+//
+// The tree as [isDir, name length, name, file size, file contents] records.
+//
+Vector<char>
+PackTree (const std::string& root)
+{
+    Vector<TreeEntry> entries;
+    ListTree(root, std::string(), entries);
+    Vector<char> buf;
+    for (const auto& e : entries)
+    {
+        Append(buf, static_cast<char>(e.isDir));
+        Append(buf, static_cast<long>(e.name.size()));
+        buf.insert(buf.end(), e.name.begin(), e.name.end());
+        if ( ! e.isDir)
+        {
+            std::ifstream ifs(root + '/' + e.name, std::ios::in | std::ios::binary | std::ios::ate);
+            if ( ! ifs.good()) {
+                amrex::FileOpenFailed(root + '/' + e.name);
+            }
+            const long size = ifs.tellg();
+            ifs.seekg(0, std::ios::beg);
+            Append(buf, size);
+            const std::size_t n = buf.size();
+            buf.resize(n + size);
+            ifs.read(buf.data() + n, size);
+        }
+    }
+    return buf;
+}
+
+void
+UnpackTree (const Vector<char>& buf, const std::string& root)
+{
+    RemoveTree(root);
+    if ( ! amrex::UtilCreateDirectory(root, 0755)) {
+        amrex::CreateDirectoryFailed(root);
+    }
+    std::size_t pos = 0;
+    while (pos < static_cast<std::size_t>(buf.size()))
+    {
+        const bool isDir = Extract<char>(buf, pos);
+        const long len = Extract<long>(buf, pos);
+        const std::string name = root + '/' + std::string(buf.data() + pos, len);
+        pos += len;
+        if (isDir)
+        {
+            if ( ! amrex::UtilCreateDirectory(name, 0755)) {
+                amrex::CreateDirectoryFailed(name);
+            }
+        }
+        else
+        {
+            const long size = Extract<long>(buf, pos);
+            std::ofstream ofs(name, std::ios::out | std::ios::trunc | std::ios::binary);
+            ofs.write(buf.data() + pos, size);
+            if ( ! ofs.good()) {
+                amrex::Error("CheckPointTier: couldn't write " + name);
+            }
+            pos += size;
+        }
+    }
+}
+
+//
+// A checkpoint directory in the local tier is complete once the number
+// of ranks that wrote it has been recorded next to it.
+//
+void
+WriteManifest (const std::string& dir)
+{
+    std::ofstream ofs(dir + ".tier", std::ios::out | std::ios::trunc);
+    ofs << ParallelDescriptor::NProcs() << '\n';
+    if ( ! ofs.good()) {
+        amrex::FileOpenFailed(dir + ".tier");
+    }
+}
+
+bool
+IsComplete (const std::string& dir)
+{
+    std::ifstream ifs(dir + ".tier");
+    int nprocs = -1;
+    ifs >> nprocs;
+    return nprocs == ParallelDescriptor::NProcs() && amrex::FileExists(dir);
+}
+
+void
+RemoveCheckPoint (const std::string& dir)
+{
+    std::remove((dir + ".tier").c_str());
+    RemoveTree(dir);
+}
+
+//
+// Sends sendbuf to dst and receives recvbuf from src, if dst and src are
+// >= 0.  A null sendbuf tells dst there is nothing to receive.  Returns
+// whether something was received.  All the ranks have to call it.
+//
+bool
+Exchange (const Vector<char>* sendbuf, int dst, Vector<char>& recvbuf, int src)
+{
+    const int sizeTag = ParallelDescriptor::SeqNum();
+    const int dataTag = ParallelDescriptor::SeqNum();
+    constexpr long chunkSize = 1L << 30;
+
+    Vector<ParallelDescriptor::Message> sends;
+    long sendSize = (sendbuf == nullptr) ? -1 : static_cast<long>(sendbuf->size());
+    if (dst >= 0)
+    {
+        sends.push_back(ParallelDescriptor::Asend(&sendSize, 1, dst, sizeTag));
+        for (long pos = 0; pos < sendSize; pos += chunkSize) {
+            sends.push_back(ParallelDescriptor::Asend(sendbuf->data() + pos,
+                                                      std::min(chunkSize, sendSize - pos),
+                                                      dst, dataTag));
+        }
+    }
+
+    long recvSize = -1;
+    if (src >= 0)
+    {
+        ParallelDescriptor::Recv(&recvSize, 1, src, sizeTag);
+        recvbuf.resize(std::max(recvSize, 0L));
+        for (long pos = 0; pos < recvSize; pos += chunkSize) {
+            ParallelDescriptor::Recv(recvbuf.data() + pos, std::min(chunkSize, recvSize - pos),
+                                     src, dataTag);
+        }
+    }
+
+    for (auto& m : sends) {
+        m.wait();
+    }
+    return recvSize >= 0;
+}
+
+std::string
+StripSlashes (std::string name)
+{
+    while (name.size() > 1 && name.back() == '/') {
+        name.pop_back();
+    }
+    return name;
+}
+
+}
+
+CheckPointTier::CheckPointTier (const std::string& local_dir, int buddy_offset)
+    : m_root(amrex::Concatenate(StripSlashes(local_dir) + "/rank_", ParallelDescriptor::MyProc(), 5))
+{
+    const int nProcs = ParallelDescriptor::NProcs();
+    const int myProc = ParallelDescriptor::MyProc();
+
+    if (buddy_offset < 0)
+    {
+        const Vector<int>& nodeIds = machine::node_ids();
+        buddy_offset = 0;
+        for (int ip = 0; ip < nProcs; ++ip) {
+            if (nodeIds[ip] == nodeIds[0]) {
+                ++buddy_offset;
+            }
+        }
+    }
+    buddy_offset %= nProcs;
+    if (buddy_offset != 0) {
+        m_buddy  = (myProc + buddy_offset) % nProcs;
+        m_source = (myProc - buddy_offset + nProcs) % nProcs;
+    }
+
+    if ( ! amrex::UtilCreateDirectory(m_root, 0755)) {
+        amrex::CreateDirectoryFailed(m_root);
+    }
+}
+
+CheckPointTier::~CheckPointTier ()
+{
+    finishDrain();
+}
+
+std::string
+CheckPointTier::dir (const std::string& name) const
+{
+    const std::string s = StripSlashes(name);
+    const std::size_t slash = s.rfind('/');
+    return m_root + '/' + (slash == std::string::npos ? s : s.substr(slash+1));
+}
+
+std::string
+CheckPointTier::buddyDir (const std::string& name) const
+{
+    return amrex::Concatenate(dir(name) + ".buddy_", m_source, 5);
+}
+
+void
+CheckPointTier::prepare (const std::string& name)
+{
+    const std::string tmp = dir(name) + ".temp";
+    RemoveTree(tmp);
+    if ( ! amrex::UtilCreateDirectory(tmp, 0755)) {
+        amrex::CreateDirectoryFailed(tmp);
+    }
+}
+
+void
+CheckPointTier::commit (const std::string& name)
+{
+    BL_PROFILE("CheckPointTier::commit()");
+
+    const std::string d = dir(name);
+
+    ParallelDescriptor::Barrier("CheckPointTier::commit");
+
+    RemoveCheckPoint(d);
+    std::rename((d + ".temp").c_str(), d.c_str());
+    WriteManifest(d);
+
+    if (m_buddy >= 0)
+    {
+        const Vector<char> sendbuf = PackTree(d);
+        Vector<char> recvbuf;
+        Exchange(&sendbuf, m_buddy, recvbuf, m_source);
+        RemoveCheckPoint(buddyDir(name));
+        UnpackTree(recvbuf, buddyDir(name));
+        WriteManifest(buddyDir(name));
+    }
+
+    if ( ! m_last.empty() && dir(m_last) != d) {
+        RemoveCheckPoint(dir(m_last));
+        if (m_buddy >= 0) {
+            RemoveCheckPoint(buddyDir(m_last));
+        }
+    }
+    m_last = name;
+}
+
+void
+CheckPointTier::drain (const std::string& name, const std::string& shared_dir)
+{
+    BL_PROFILE("CheckPointTier::drain()");
+
+    finishDrain();
+
+    const std::string shared = StripSlashes(shared_dir);
+    amrex::UtilRenameDirectoryToOld(shared, false);
+    amrex::UtilCreateCleanDirectory(shared + ".temp", true);
+
+    m_drain = std::async(std::launch::async, CopyTree, dir(name), shared + ".temp");
+}
+
+void
+CheckPointTier::finishDrain ()
+{
+    if (m_drain.valid()) {
+        m_drain.get();
+    }
+}
+
+bool
+CheckPointTier::restore (const std::string& name, const std::string& shared_dir)
+{
+    BL_PROFILE("CheckPointTier::restore()");
+
+    const int nProcs = ParallelDescriptor::NProcs();
+    const int myProc = ParallelDescriptor::MyProc();
+    const std::string shared = StripSlashes(shared_dir);
+
+    //
+    // The shared checkpoint only gets its final name once it is drained.
+    //
+    int sharedExists = ParallelDescriptor::IOProcessor() ? amrex::FileExists(shared) : 0;
+    ParallelDescriptor::Bcast(&sharedExists, 1, ParallelDescriptor::IOProcessorNumber());
+    if (sharedExists) {
+        return false;
+    }
+
+    const std::string d = dir(name);
+    int have = IsComplete(d);
+    Vector<int> haveAll(nProcs);
+    ParallelAllGather::AllGather(have, haveAll.data(), ParallelDescriptor::Communicator());
+
+    //
+    // Ranks that lost their part get it back from their buddy.
+    //
+    if (m_buddy >= 0)
+    {
+        const bool sendBack = ! haveAll[m_source];
+        const bool getBack  = ! haveAll[myProc];
+        Vector<char> sendbuf;
+        const bool haveCopy = sendBack && IsComplete(buddyDir(name));
+        if (haveCopy) {
+            sendbuf = PackTree(buddyDir(name));
+        }
+        Vector<char> recvbuf;
+        if (Exchange(haveCopy ? &sendbuf : nullptr, sendBack ? m_source : -1,
+                     recvbuf, getBack ? m_buddy : -1))
+        {
+            UnpackTree(recvbuf, d);
+            WriteManifest(d);
+            have = 1;
+        }
+    }
+
+    ParallelDescriptor::ReduceIntMin(have);
+    if ( ! have) {
+        return false;
+    }
+
+    amrex::UtilCreateCleanDirectory(shared + ".temp", true);
+    CopyTree(d, shared + ".temp");
+    ParallelDescriptor::Barrier("CheckPointTier::restore");
+    if (ParallelDescriptor::IOProcessor()) {
+        std::rename((shared + ".temp").c_str(), shared.c_str());
+    }
+    ParallelDescriptor::Barrier("CheckPointTier::restore::rename");
+
+    m_last = name;
+    return true;
+}
+
+}
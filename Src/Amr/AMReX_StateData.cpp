@@ -1,6 +1,8 @@
 
 #include <iostream>
+#include <sstream>
 #include <algorithm>
+#include <cstring>
 
 #include <unistd.h>
 
@@ -9,6 +11,7 @@
 #include <AMReX_StateDescriptor.H>
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_Utility.H>
+#include <AMReX_ParallelReduce.H>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -23,6 +26,65 @@ static constexpr int MFOLDDATA = 1;
 
 Vector<std::string> StateData::fabArrayHeaderNames;
 std::map<std::string, Vector<char> > *StateData::faHeaderMap;
+StateData::CheckPointMode StateData::checkpoint_mode = StateData::CheckPointMode::Full;
+std::string StateData::checkpoint_name;
+
+namespace {
+
+inline std::uint64_t rotl (std::uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+constexpr std::uint64_t hash_prime1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t hash_prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t hash_prime3 = 0x165667B19E3779F9ULL;
+
+inline std::uint64_t hash_round (std::uint64_t h, std::uint64_t w)
+{
+    return rotl(h + w * hash_prime2, 31) * hash_prime1;
+}
+
+//
+// A fast 64-bit hash of the bits of a FAB, ghost cells included.
+// Four independent lanes keep the multiplies pipelined.
+//
+std::uint64_t
+HashFab (const FArrayBox& fab)
+{
+    const char* p = reinterpret_cast<const char*>(fab.dataPtr());
+    const std::size_t nbytes = fab.nBytes();
+    const std::size_t nwords = nbytes / sizeof(std::uint64_t);
+
+    std::uint64_t h[4] = { hash_prime1, hash_prime2, ~hash_prime1, ~hash_prime2 };
+    std::size_t i = 0;
+    for ( ; i + 4 <= nwords; i += 4) {
+        for (int l = 0; l < 4; ++l) {
+            std::uint64_t w;
+            std::memcpy(&w, p + (i+l)*sizeof(std::uint64_t), sizeof(std::uint64_t));
+            h[l] = hash_round(h[l], w);
+        }
+    }
+
+    std::uint64_t r = rotl(h[0],1) + rotl(h[1],7) + rotl(h[2],12) + rotl(h[3],18);
+    for ( ; i < nwords; ++i) {
+        std::uint64_t w;
+        std::memcpy(&w, p + i*sizeof(std::uint64_t), sizeof(std::uint64_t));
+        r = rotl(r ^ hash_round(0, w), 27) * hash_prime1 + hash_prime3;
+    }
+    if (nbytes % sizeof(std::uint64_t) != 0) {
+        std::uint64_t w = 0;
+        std::memcpy(&w, p + nwords*sizeof(std::uint64_t), nbytes % sizeof(std::uint64_t));
+        r = rotl(r ^ hash_round(0, w), 27) * hash_prime1 + hash_prime3;
+    }
+
+    r ^= nbytes;
+    r ^= r >> 33;
+    r *= hash_prime2;
+    r ^= r >> 29;
+    r *= hash_prime3;
+    r ^= r >> 32;
+    return r;
+}
+
+}
 
 
 StateData::StateData () 
@@ -52,7 +114,8 @@ StateData::StateData (StateData&& rhs) noexcept
       new_time(rhs.new_time),
       old_time(rhs.old_time),
       new_data(std::move(rhs.new_data)),
-      old_data(std::move(rhs.old_data))
+      old_data(std::move(rhs.old_data)),
+      chk_base(std::move(rhs.chk_base))
 {   
 }
 
@@ -237,6 +300,20 @@ StateData::restartDoit (std::istream& is, const std::string& chkfile)
 
       is >> mf_name;
       //
+      // A delta checkpoint has the name of the checkpoint with the whole
+      // MultiFab and the number of FABs changed since on the same line.
+      //
+      std::string base_name;
+      int nchanged = 0;
+      {
+          std::string delta_line;
+          std::getline(is, delta_line);
+          std::istringstream dis(delta_line);
+          if ( ! (dis >> base_name >> nchanged)) {
+              base_name.clear();
+          }
+      }
+      //
       // Note that mf_name is relative to the Header file.
       // We need to prepend the name of the chkfile directory.
       //
@@ -246,6 +323,33 @@ StateData::restartDoit (std::istream& is, const std::string& chkfile)
       }
       FullPathName += mf_name;
 
+      if ( ! base_name.empty())
+      {
+          //
+          // The base checkpoint is in the same directory as chkfile.
+          //
+          std::string chkdir(chkfile);
+          while ( ! chkdir.empty() && chkdir[chkdir.length()-1] == '/') {
+              chkdir.pop_back();
+          }
+          const std::size_t slash = chkdir.rfind('/');
+          chkdir = (slash == std::string::npos) ? std::string() : chkdir.substr(0, slash+1);
+
+          VisMF::Read(*whichMF, chkdir + base_name + '/' + mf_name);
+
+          if (nchanged > 0) {
+              const char *faHeader = nullptr;
+              if (faHeaderMap != nullptr) {
+                  auto fahmIter = faHeaderMap->find(FullPathName + "_H");
+                  if (fahmIter != faHeaderMap->end()) {
+                      faHeader = fahmIter->second.dataPtr();
+                  }
+              }
+              readDelta(*whichMF, FullPathName, faHeader);
+          }
+          continue;
+      }
+
       // ---- check for preread header
       std::string FullHeaderPathName(FullPathName + "_H");
       const char *faHeader = 0;
@@ -745,6 +849,111 @@ StateData::getData (Vector<MultiFab*>& data,
     }
 }
 
+void
+StateData::SetCheckPointMode (CheckPointMode mode, const std::string& chkname)
+{
+    checkpoint_mode = mode;
+    checkpoint_name = (mode == CheckPointMode::Full) ? std::string() : chkname;
+}
+
+bool
+StateData::changedFabs (const MultiFab& mf, CheckPointBase& base, Vector<int>& changed)
+{
+    BL_PROFILE("StateData::changedFabs()");
+
+    changed.clear();
+
+    if (checkpoint_mode == CheckPointMode::Full) {
+        return false;
+    }
+
+    Vector<std::uint64_t> hash(mf.local_size());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        hash[mfi.LocalIndex()] = HashFab(mf[mfi]);
+    }
+
+    const bool use_base = checkpoint_mode == CheckPointMode::Delta
+        && ! base.name.empty()
+        && base.grids == mf.boxArray()
+        && base.dmap  == mf.DistributionMap()
+        && base.hash.size() == hash.size();
+
+    if ( ! use_base)
+    {
+        //
+        // Everything gets written and becomes the base of later deltas.
+        //
+        base.name  = checkpoint_name;
+        base.grids = mf.boxArray();
+        base.dmap  = mf.DistributionMap();
+        base.hash  = std::move(hash);
+        return false;
+    }
+
+    Vector<int> flags(mf.size(), 0);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const int li = mfi.LocalIndex();
+        if (hash[li] != base.hash[li]) {
+            flags[mfi.index()] = 1;
+        }
+    }
+    ParallelAllReduce::Max(flags.data(), flags.size(), ParallelContext::CommunicatorSub());
+
+    for (int i = 0, N = flags.size(); i < N; ++i) {
+        if (flags[i]) {
+            changed.push_back(i);
+        }
+    }
+    return true;
+}
+
+void
+StateData::readDelta (MultiFab& mf, const std::string& delta_name, const char* faHeader)
+{
+    BL_PROFILE("StateData::readDelta()");
+
+    Vector<char> faHeaderChars;
+    if (faHeader == nullptr) {
+        VisMF::ReadFAHeader(delta_name, faHeaderChars);
+        faHeader = faHeaderChars.dataPtr();
+    }
+
+    VisMF::Header hdr;
+    {
+        std::istringstream is(faHeader);
+        is >> hdr;
+    }
+
+    //
+    // The FABs in the delta are in the same order as in mf.
+    //
+    const BoxArray& ba = mf.boxArray();
+    const DistributionMapping& dm = mf.DistributionMap();
+    const BoxArray& dba = hdr.m_ba;
+    Vector<int> index(dba.size());
+    Vector<int> pmap(dba.size());
+    for (int i = 0, j = 0, N = dba.size(); i < N; ++i, ++j) {
+        while (j < ba.size() && ba[j] != dba[i]) {
+            ++j;
+        }
+        if (j == ba.size()) {
+            amrex::Abort("StateData::readDelta: " + delta_name + " does not match the grids");
+        }
+        index[i] = j;
+        pmap[i]  = dm[j];
+    }
+
+    MultiFab delta(dba, DistributionMapping(std::move(pmap)), mf.nComp(), mf.nGrowVect());
+    VisMF::Read(delta, delta_name, faHeader);
+
+    for (MFIter mfi(delta); mfi.isValid(); ++mfi) {
+        mf[index[mfi.index()]].copy(delta[mfi]);
+    }
+}
+
 void
 StateData::checkPoint (const std::string& name,
                        const std::string& fullpathname,
@@ -761,13 +970,25 @@ StateData::checkPoint (const std::string& name,
         dump_old = false;
     }
 
+    //
+    // With a delta checkpoint only the FABs changed since the base
+    // checkpoint get written.
+    //
+    const int nsets = desc->store_in_checkpoint() ? (dump_old ? 2 : 1) : 0;
+    MultiFab* mfs[2] = { new_data.get(), old_data.get() };
+    bool is_delta[2] = { false, false };
+    Vector<int> changed[2];
+    for (int i = 0; i < nsets; ++i) {
+        BL_ASSERT(mfs[i]);
+        is_delta[i] = changedFabs(*mfs[i], chk_base[i], changed[i]);
+    }
+
     if (ParallelDescriptor::IOProcessor())
     {
         //
         // The relative name gets written to the Header file.
         //
-        std::string mf_name_old(name + OldSuffix);
-        std::string mf_name_new(name + NewSuffix);
+        const std::string mf_name[2] = { name + NewSuffix, name + OldSuffix };
 
         os << domain << '\n';
 
@@ -778,38 +999,45 @@ StateData::checkPoint (const std::string& name,
            << new_time.start << '\n'
            << new_time.stop  << '\n';
 
-        if (desc->store_in_checkpoint()) 
-        {
-           if (dump_old)
-           {
-               os << 2 << '\n' << mf_name_new << '\n' << mf_name_old << '\n';
-	       fabArrayHeaderNames.push_back(mf_name_new);
-	       fabArrayHeaderNames.push_back(mf_name_old);
-           }
-           else
-           {
-               os << 1 << '\n' << mf_name_new << '\n';
-	       fabArrayHeaderNames.push_back(mf_name_new);
-           }
-        }
-        else
+        os << nsets << '\n';
+        for (int i = 0; i < nsets; ++i)
         {
-               os << 0 << '\n';
+            os << mf_name[i];
+            if (is_delta[i]) {
+                os << ' ' << chk_base[i].name << ' ' << changed[i].size();
+            }
+            os << '\n';
+            if ( ! is_delta[i] || ! changed[i].empty()) {
+                fabArrayHeaderNames.push_back(mf_name[i]);
+            }
         }
     }
 
-    if (desc->store_in_checkpoint())
+    const std::string suffix[2] = { NewSuffix, OldSuffix };
+    for (int i = 0; i < nsets; ++i)
     {
-       BL_ASSERT(new_data);
-       std::string mf_fullpath_new(fullpathname + NewSuffix);
-       VisMF::Write(*new_data,mf_fullpath_new,how);
-
-       if (dump_old)
-       {
-           BL_ASSERT(old_data);
-           std::string mf_fullpath_old(fullpathname + OldSuffix);
-           VisMF::Write(*old_data,mf_fullpath_old,how);
-       }
+        const std::string mf_fullpath(fullpathname + suffix[i]);
+        if ( ! is_delta[i])
+        {
+            VisMF::Write(*mfs[i],mf_fullpath,how);
+        }
+        else if ( ! changed[i].empty())
+        {
+            const MultiFab& mf = *mfs[i];
+            const int nchanged = changed[i].size();
+            BoxList bl(mf.boxArray().ixType());
+            Vector<int> pmap(nchanged);
+            for (int k = 0; k < nchanged; ++k) {
+                bl.push_back(mf.boxArray()[changed[i][k]]);
+                pmap[k] = mf.DistributionMap()[changed[i][k]];
+            }
+            MultiFab delta(BoxArray(std::move(bl)), DistributionMapping(std::move(pmap)),
+                           mf.nComp(), mf.nGrowVect());
+            for (MFIter mfi(delta); mfi.isValid(); ++mfi) {
+                delta[mfi].copy(mf[changed[i][mfi.index()]]);
+            }
+            VisMF::Write(delta,mf_fullpath,how);
+        }
     }
 }
 
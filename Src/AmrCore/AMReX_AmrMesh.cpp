@@ -76,6 +76,7 @@ AmrMesh::InitAmrMesh (int max_level_in, const Vector<int>& n_cell_in,
 
     use_new_chop         = false;
     iterate_on_new_grids = true;
+    distributed_clustering = false;
 
     ParmParse pp("amr");
 
@@ -373,6 +374,8 @@ AmrMesh::InitAmrMesh (int max_level_in, const Vector<int>& n_cell_in,
 
     pp.query("check_input", check_input);
 
+    pp.query("distributed_clustering", distributed_clustering);
+
     finest_level = -1;
 
     if (check_input) checkInput();
@@ -709,10 +712,24 @@ AmrMesh::MakeNewGrids (int lbase, Real time, int& new_finest, Vector<BoxArray>&
         // Create initial cluster containing all tagged points.
         //
 	Vector<IntVect> tagvec;
-	tags.collate(tagvec);
+        long ntags;
+        if (distributed_clustering)
+        {
+            //
+            // Each process only keeps the tags it owns.
+            //
+            tags.local_collate(tagvec, true);
+            ntags = tagvec.size();
+            ParallelDescriptor::ReduceLongSum(ntags);
+        }
+        else
+        {
+            tags.collate(tagvec);
+            ntags = tagvec.size();
+        }
         tags.clear();
 
-        if (tagvec.size() > 0)
+        if (ntags > 0)
         {
             //
             // Created new level, now generate efficient grids.
@@ -720,26 +737,41 @@ AmrMesh::MakeNewGrids (int lbase, Real time, int& new_finest, Vector<BoxArray>&
             if ( !(useFixedCoarseGrids() && levc<useFixedUpToLevel()) ) {
                 new_finest = std::max(new_finest,levf);
 	    }
-            //
-            // Construct initial cluster.
-            //
-            ClusterList clist(&tagvec[0], tagvec.size());
-            if (use_new_chop)
+
+            BoxList new_bx;
+            if (distributed_clustering)
             {
-               clist.new_chop(grid_eff);
-            } else {
-               clist.chop(grid_eff);
+                //
+                // Cluster the tags of all processes together without
+                // gathering them.  This gives the same boxes as below.
+                //
+                BoxDomain bd;
+                bd.add(p_n[levc]);
+                new_bx = DistributedCluster(tagvec, grid_eff, use_new_chop, bd);
             }
-            BoxDomain bd;
-            bd.add(p_n[levc]);
-            clist.intersect(bd);
-            bd.clear();
-            //
-            // Efficient properly nested Clusters have been constructed
-            // now generate list of grids at level levf.
-            //
-            BoxList new_bx;
-            clist.boxList(new_bx);
+            else
+            {
+                //
+                // Construct initial cluster.
+                //
+                ClusterList clist(&tagvec[0], tagvec.size());
+                if (use_new_chop)
+                {
+                    clist.new_chop(grid_eff);
+                } else {
+                    clist.chop(grid_eff);
+                }
+                BoxDomain bd;
+                bd.add(p_n[levc]);
+                clist.intersect(bd);
+                bd.clear();
+                //
+                // Efficient properly nested Clusters have been constructed
+                // now generate list of grids at level levf.
+                //
+                clist.boxList(new_bx);
+            }
+
             new_bx.refine(bf_lev[levc]);
             new_bx.simplify();
             BL_ASSERT(new_bx.isDisjoint());
@@ -1,8 +1,11 @@
 
 #include <algorithm>
+#include <climits>
 #include <cmath>
 #include <AMReX_Cluster.H>
 #include <AMReX_BoxDomain.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_BLProfiler.H>
 
 namespace amrex {
 
@@ -604,4 +607,361 @@ ClusterList::intersect (const BoxDomain& dom)
     }
 }
 
+namespace {
+//
+// A region of the distributed clustering.  Its box is the search box until
+// the signature is known and the minimal box of its tags after that.
+//
+struct DCRegion
+{
+    Box         box;
+    long        begin     = 0;     // range of the local tags in the region
+    long        end       = 0;
+    long        ntags     = 0;     // number of tags on all the processes
+    int         parent    = -1;
+    int         lo        = -1;    // the two halves after a cut
+    int         hi        = -1;
+    int         cutdir    = -1;
+    bool        tentative = false; // new_chop() cut that may still be reverted
+    bool        dead      = false; // half of a reverted cut
+    Vector<int> hist[AMREX_SPACEDIM];
+
+    Real eff () const noexcept { return ntags/box.d_numPts(); }
+};
+
+//
+// Selects the cut of a region from its signature as Cluster::chop() does,
+// skipping direction invalid_dir.  Returns false if there is no valid cut.
+//
+bool
+SelectCut (const DCRegion& rg,
+           int             invalid_dir,
+           int&            dir,
+           int&            cutpos)
+{
+    const int* lo = rg.box.loVect();
+    const int* hi = rg.box.hiVect();
+
+    CutStatus mincut = InvalidCut;
+    CutStatus status[AMREX_SPACEDIM];
+    IntVect cut;
+    for (int n = 0; n < AMREX_SPACEDIM; n++)
+    {
+        status[n] = InvalidCut;
+        if (n != invalid_dir)
+        {
+            cut[n] = FindCut(rg.hist[n].dataPtr(), lo[n], hi[n], status[n]);
+            if (status[n] < mincut)
+            {
+                mincut = status[n];
+            }
+        }
+    }
+    if (mincut == InvalidCut)
+        return false;
+
+    dir = -1;
+    for (int n = 0, minlen = -1; n < AMREX_SPACEDIM; n++)
+    {
+        if (status[n] == mincut)
+        {
+            int mincutlen = std::min(cut[n]-lo[n],hi[n]-cut[n]);
+            if (mincutlen >= minlen)
+            {
+                dir = n;
+                minlen = mincutlen;
+            }
+        }
+    }
+    BL_ASSERT(dir >= 0 && dir < AMREX_SPACEDIM);
+
+    cutpos = cut[dir];
+    return true;
+}
+
+//
+// Cuts region irg into two halves, which are added to the regions and to next.
+//
+void
+SplitRegion (Vector<DCRegion>& regions,
+             int               irg,
+             int               dir,
+             int               cutpos,
+             Vector<IntVect>&  tags,
+             Vector<int>&      next)
+{
+    IntVect cut;
+    cut[dir] = cutpos;
+    IntVect* first = tags.dataPtr();
+    IntVect* prt_it = std::partition(first+regions[irg].begin, first+regions[irg].end, Cut(cut,dir));
+
+    DCRegion lo, hi;
+    lo.box    = regions[irg].box;
+    hi.box    = regions[irg].box;
+    lo.box.setBig(dir,cutpos-1);
+    hi.box.setSmall(dir,cutpos);
+    lo.begin  = regions[irg].begin;
+    lo.end    = prt_it - first;
+    hi.begin  = lo.end;
+    hi.end    = regions[irg].end;
+    lo.parent = hi.parent = irg;
+
+    regions[irg].cutdir = dir;
+    regions[irg].lo     = regions.size();
+    regions.push_back(std::move(lo));
+    next.push_back(regions[irg].lo);
+    regions[irg].hi     = regions.size();
+    regions.push_back(std::move(hi));
+    next.push_back(regions[irg].hi);
+}
+}
+
+BoxList
+DistributedCluster (Vector<IntVect>& tags,
+                    Real             eff,
+                    bool             use_new_chop,
+                    const BoxDomain& dom)
+{
+    BL_PROFILE("DistributedCluster()");
+
+    BoxList bl;
+    //
+    // The first region is the bounding box of all the tags.
+    //
+    int bnd[2*AMREX_SPACEDIM];
+    for (int n = 0; n < 2*AMREX_SPACEDIM; n++)
+        bnd[n] = INT_MAX;
+    for (const IntVect& iv : tags)
+    {
+        for (int n = 0; n < AMREX_SPACEDIM; n++)
+        {
+            bnd[n]                = std::min(bnd[n], iv[n]);
+            bnd[n+AMREX_SPACEDIM] = std::min(bnd[n+AMREX_SPACEDIM], -iv[n]);
+        }
+    }
+    ParallelDescriptor::ReduceIntMin(bnd, 2*AMREX_SPACEDIM);
+    if (bnd[0] == INT_MAX)
+        return bl;
+
+    Vector<DCRegion> regions(1);
+    regions[0].box = Box(IntVect(AMREX_D_DECL(bnd[0],bnd[1],bnd[2])),
+                         IntVect(AMREX_D_DECL(-bnd[AMREX_SPACEDIM],-bnd[AMREX_SPACEDIM+1],-bnd[AMREX_SPACEDIM+2])));
+    regions[0].end = tags.size();
+
+    Vector<int> active(1,0), next;
+    Vector<long> offset;
+    Vector<int> sig;
+
+    while (!active.empty())
+    {
+        //
+        // Compute the local signatures of all the active regions and sum them
+        // over the processes.
+        //
+        offset.resize(active.size()+1);
+        offset[0] = 0;
+        for (int k = 0; k < active.size(); k++)
+        {
+            const IntVect& len = regions[active[k]].box.size();
+            offset[k+1] = offset[k] + AMREX_D_TERM(len[0],+len[1],+len[2]);
+        }
+        sig.assign(offset.back(), 0);
+
+        for (int k = 0; k < active.size(); k++)
+        {
+            const DCRegion& rg = regions[active[k]];
+            const IntVect& lo  = rg.box.smallEnd();
+            const IntVect& len = rg.box.size();
+            int* h[AMREX_SPACEDIM];
+            h[0] = &sig[offset[k]];
+            for (int n = 1; n < AMREX_SPACEDIM; n++)
+                h[n] = h[n-1] + len[n-1];
+            for (long i = rg.begin; i < rg.end; i++)
+            {
+                const IntVect& iv = tags[i];
+                AMREX_D_TERM( h[0][iv[0]-lo[0]]++;,
+                              h[1][iv[1]-lo[1]]++;,
+                              h[2][iv[2]-lo[2]]++; )
+            }
+        }
+
+        ParallelDescriptor::ReduceIntSum(sig.dataPtr(), sig.size());
+        //
+        // Shrink the regions to the minimal boxes of their tags.
+        //
+        for (int k = 0; k < active.size(); k++)
+        {
+            DCRegion& rg = regions[active[k]];
+            const IntVect len = rg.box.size();
+            const int* h = &sig[offset[k]];
+            IntVect lo, hi;
+            for (int n = 0; n < AMREX_SPACEDIM; n++)
+            {
+                int ilo = 0, ihi = len[n]-1;
+                while (h[ilo] == 0) ilo++;
+                while (h[ihi] == 0) ihi--;
+                lo[n] = rg.box.smallEnd(n) + ilo;
+                hi[n] = rg.box.smallEnd(n) + ihi;
+                rg.hist[n].assign(h+ilo, h+ihi+1);
+                if (n == 0)
+                {
+                    rg.ntags = 0;
+                    for (int i = ilo; i <= ihi; i++)
+                        rg.ntags += h[i];
+                }
+                h += len[n];
+            }
+            rg.box = Box(lo,hi);
+        }
+        //
+        // Accept or cut the regions.
+        //
+        next.clear();
+
+        for (int k = 0; k < active.size(); k++)
+        {
+            const int irg = active[k];
+            const int ipr = regions[irg].parent;
+
+            if (ipr >= 0 && regions[ipr].tentative)
+            {
+                //
+                // Both halves are in this round, the lower one first.  As in
+                // Cluster::new_chop(), revert the cut if neither half is more
+                // efficient than the region and cut in another direction.
+                //
+                BL_ASSERT(irg == regions[ipr].lo);
+                regions[ipr].tentative = false;
+                const Real oldeff = regions[ipr].eff();
+                int dir, cutpos;
+                if ( !(regions[regions[ipr].lo].eff() > oldeff || regions[regions[ipr].hi].eff() > oldeff) &&
+                     SelectCut(regions[ipr], regions[ipr].cutdir, dir, cutpos) )
+                {
+                    regions[regions[ipr].lo].dead = true;
+                    regions[regions[ipr].hi].dead = true;
+                    SplitRegion(regions, ipr, dir, cutpos, tags, next);
+                }
+                for (int n = 0; n < AMREX_SPACEDIM; n++)
+                    Vector<int>().swap(regions[ipr].hist[n]);
+            }
+
+            if (regions[irg].dead)
+                continue;
+
+            int dir, cutpos;
+            if (regions[irg].eff() < eff && SelectCut(regions[irg], -1, dir, cutpos))
+            {
+                SplitRegion(regions, irg, dir, cutpos, tags, next);
+                regions[irg].tentative = use_new_chop;
+            }
+
+            if (!regions[irg].tentative)
+            {
+                for (int n = 0; n < AMREX_SPACEDIM; n++)
+                    Vector<int>().swap(regions[irg].hist[n]);
+            }
+        }
+
+        std::swap(active, next);
+    }
+    //
+    // Put the clusters in the order ClusterList::chop() leaves them in.
+    //
+    Vector<int> clusters(1,0);
+    for (int i = 0; i < clusters.size(); i++)
+    {
+        int irg = clusters[i];
+        while (regions[irg].lo >= 0)
+        {
+            clusters.push_back(regions[irg].hi);
+            irg = regions[irg].lo;
+        }
+        clusters[i] = irg;
+    }
+    //
+    // Intersect each process's share of the clusters with dom and gather the
+    // results.  A cluster that lies in dom is returned as it is.
+    //
+    const long nclusters = clusters.size();
+    const int  nprocs    = ParallelDescriptor::NProcs();
+    const int  myproc    = ParallelDescriptor::MyProc();
+
+    BoxArray domba(dom.boxList());
+    Vector<Box> bxs;
+    for (long i = nclusters*myproc/nprocs; i < nclusters*(myproc+1)/nprocs; i++)
+    {
+        const Box& bx = regions[clusters[i]].box;
+        bool assume_disjoint_ba = true;
+        if (domba.contains(bx,assume_disjoint_ba))
+        {
+            bxs.push_back(bx);
+        }
+        else
+        {
+            BoxDomain bxdom;
+            amrex::intersect(bxdom, dom, bx);
+            for (const Box& b : bxdom)
+                bxs.push_back(b);
+        }
+    }
+
+    amrex::AllGatherBoxes(bxs);
+    //
+    // The clusters are disjoint, so each piece of a cluster cut by dom is
+    // found in the cluster before it in the gathered list.  Shrink the pieces
+    // to the minimal boxes of their tags and put them after the clusters that
+    // lie in dom, as ClusterList::intersect() does.
+    //
+    Vector<Box> pieces;
+    Vector<int> pieces_rg;
+    for (int i = 0, k = 0; i < bxs.size(); i++)
+    {
+        while (!regions[clusters[k]].box.contains(bxs[i]))
+            k++;
+        if (bxs[i] == regions[clusters[k]].box)
+        {
+            bl.push_back(bxs[i]);
+        }
+        else
+        {
+            pieces.push_back(bxs[i]);
+            pieces_rg.push_back(clusters[k]);
+        }
+    }
+
+    Vector<int> pbnd(2*AMREX_SPACEDIM*pieces.size(), INT_MAX);
+    IntVect* prt_it = nullptr;
+    for (int p = 0; p < pieces.size(); p++)
+    {
+        const DCRegion& rg = regions[pieces_rg[p]];
+        if (p == 0 || pieces_rg[p] != pieces_rg[p-1])
+            prt_it = tags.dataPtr() + rg.begin;
+        IntVect* first = prt_it;
+        prt_it = std::partition(first, tags.dataPtr() + rg.end, InBox(pieces[p]));
+        int* b = &pbnd[2*AMREX_SPACEDIM*p];
+        for (IntVect* it = first; it != prt_it; ++it)
+        {
+            for (int n = 0; n < AMREX_SPACEDIM; n++)
+            {
+                b[n]                = std::min(b[n], (*it)[n]);
+                b[n+AMREX_SPACEDIM] = std::min(b[n+AMREX_SPACEDIM], -(*it)[n]);
+            }
+        }
+    }
+
+    ParallelDescriptor::ReduceIntMin(pbnd.dataPtr(), pbnd.size());
+
+    for (int p = 0; p < pieces.size(); p++)
+    {
+        const int* b = &pbnd[2*AMREX_SPACEDIM*p];
+        if (b[0] != INT_MAX)
+        {
+            bl.push_back(Box(IntVect(AMREX_D_DECL(b[0],b[1],b[2])),
+                             IntVect(AMREX_D_DECL(-b[AMREX_SPACEDIM],-b[AMREX_SPACEDIM+1],-b[AMREX_SPACEDIM+2]))));
+        }
+    }
+
+    return bl;
+}
+
 }
@@ -2,6 +2,8 @@
 #include <cstdlib>
 #include <cmath>
 #include <climits>
+#include <map>
+#include <set>
 
 #include <AMReX_TagBox.H>
 #include <AMReX_Geometry.H>
@@ -513,9 +515,9 @@ TagBoxArray::numTags () const
 }
 
 void
-TagBoxArray::collate (Vector<IntVect>& TheGlobalCollateSpace) const
+TagBoxArray::local_collate (Vector<IntVect>& TheLocalCollateSpace, bool owned_only) const
 {
-    BL_PROFILE("TagBoxArray::collate()");
+    BL_PROFILE("TagBoxArray::local_collate()");
 
     long count = 0;
 
@@ -527,24 +529,112 @@ TagBoxArray::collate (Vector<IntVect>& TheGlobalCollateSpace) const
         count += get(fai).numTags();
     }
 
-    //
-    // Local space for holding just those tags we want to gather to the root cpu.
-    //
-    Vector<IntVect> TheLocalCollateSpace(count);
+    TheLocalCollateSpace.resize(count);
 
     count = 0;
 
+    //
+    // With owned_only a cell covered by several TagBoxes is owned by the
+    // one with the smallest index.  The tags of a cell may differ between
+    // the TagBoxes covering it, so they are all sent to the owner.
+    //
+    const int MyProc = ParallelDescriptor::MyProc();
+    std::map<int,Vector<int> > send_tags;
+    std::set<int> recv_procs;
+    std::vector< std::pair<int,Box> > isects;
+
     // unsafe to do OMP
     for (MFIter fai(*this); fai.isValid(); ++fai)
     {
-        count += get(fai).collate(TheLocalCollateSpace,count);
+        long n = get(fai).collate(TheLocalCollateSpace,count);
+
+        if (owned_only)
+        {
+            const int idx = fai.index();
+            boxarray.intersections(get(fai).box(), isects, false, n_grow);
+            isects.erase(std::remove_if(isects.begin(), isects.end(),
+                                        [&] (const std::pair<int,Box>& is) {
+                                            if (is.first > idx && distributionMap[is.first] != MyProc) {
+                                                recv_procs.insert(distributionMap[is.first]);
+                                            }
+                                            return is.first >= idx;
+                                        }),
+                         isects.end());
+            if (!isects.empty())
+            {
+                IntVect* first = &TheLocalCollateSpace[count];
+                n = std::remove_if(first, first+n, [&] (const IntVect& iv) {
+                        int owner = idx;
+                        for (const auto& is : isects) {
+                            if (is.first < owner && is.second.contains(iv)) owner = is.first;
+                        }
+                        const int proc = distributionMap[owner];
+                        if (proc == MyProc) return false;
+                        Vector<int>& buf = send_tags[proc];
+                        buf.insert(buf.end(), iv.getVect(), iv.getVect()+AMREX_SPACEDIM);
+                        return true;
+                    }) - first;
+                for (const auto& is : isects) {
+                    if (distributionMap[is.first] != MyProc) {
+                        send_tags[distributionMap[is.first]];
+                    }
+                }
+            }
+        }
+
+        count += n;
     }
 
-    if (count > 0)
+    TheLocalCollateSpace.resize(count);
+
+#ifdef BL_USE_MPI
+    if (owned_only)
+    {
+        //
+        // Every process that may send to us sends a (possibly empty) message.
+        //
+        const int SeqNum = ParallelDescriptor::SeqNum();
+        Vector<ParallelDescriptor::Message> sends;
+        for (auto& kv : send_tags) {
+            sends.push_back(ParallelDescriptor::Asend(kv.second.data(), kv.second.size(),
+                                                      kv.first, SeqNum));
+        }
+        for (int proc : recv_procs)
+        {
+            MPI_Status status;
+            BL_MPI_REQUIRE( MPI_Probe(proc, SeqNum, ParallelDescriptor::Communicator(), &status) );
+            int ncount;
+            BL_MPI_REQUIRE( MPI_Get_count(&status, MPI_INT, &ncount) );
+            Vector<int> buf(ncount);
+            ParallelDescriptor::Recv(buf.data(), ncount, proc, SeqNum);
+            for (int i = 0; i < ncount; i += AMREX_SPACEDIM) {
+                TheLocalCollateSpace.push_back(IntVect(&buf[i]));
+            }
+        }
+        for (auto& m : sends) {
+            m.wait();
+        }
+    }
+#endif
+
+    if (!TheLocalCollateSpace.empty())
     {
         amrex::RemoveDuplicates(TheLocalCollateSpace);
-	count = TheLocalCollateSpace.size();
     }
+}
+
+void
+TagBoxArray::collate (Vector<IntVect>& TheGlobalCollateSpace) const
+{
+    BL_PROFILE("TagBoxArray::collate()");
+
+    //
+    // Local space for holding just those tags we want to gather to the root cpu.
+    //
+    Vector<IntVect> TheLocalCollateSpace;
+    local_collate(TheLocalCollateSpace);
+    long count = TheLocalCollateSpace.size();
+
     //
     // The total number of tags system wide that must be collated.
     // This is really just an estimate of the upper bound due to duplicates.
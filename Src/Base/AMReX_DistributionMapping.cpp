@@ -10,6 +10,7 @@
 #endif
 #include <AMReX_VisMF.H>
 #include <AMReX_Utility.H>
+#include <AMReX_Machine.H>
 
 #include <iostream>
 #include <fstream>
@@ -75,6 +76,9 @@ DistributionMapping::strategy (DistributionMapping::Strategy how)
     case RRSFC:
         m_BuildMap = &DistributionMapping::RRSFCProcessorMap;
         break;
+    case GRAPH:
+        m_BuildMap = &DistributionMapping::GraphProcessorMap;
+        break;
     default:
         amrex::Error("Bad DistributionMapping::Strategy");
     }
@@ -146,6 +150,10 @@ DistributionMapping::Initialize ()
         {
             strategy(RRSFC);
         }
+        else if (theStrategy == "GRAPH")
+        {
+            strategy(GRAPH);
+        }
         else
         {
             std::string msg("Unknown strategy: ");
@@ -1327,6 +1335,655 @@ DistributionMapping::RRSFCProcessorMap (const BoxArray&          boxes,
     RRSFCDoIt(boxes,nprocs);
 }
 
+namespace
+{
+    //
+    // A graph of the boxes in compressed sparse row form.  Boxes are
+    // neighbors when one is within a ghost cell of the other, possibly
+    // through a periodic boundary.  The edge weight is the area of the
+    // faces they share, or 1 if they only touch at an edge or corner.
+    //
+    struct BoxGraph
+    {
+        std::vector<int>  xadj;
+        std::vector<int>  adjncy;
+        std::vector<long> adjwgt;
+        std::vector<long> vwgt;
+
+        int size () const { return vwgt.size(); }
+
+        long totalWeight () const {
+            return std::accumulate(vwgt.begin(), vwgt.end(), 0L);
+        }
+    };
+
+    BoxGraph
+    MakeBoxGraph (const BoxArray& boxes, const std::vector<long>& wgts,
+                  const Periodicity& period)
+    {
+        const int N = boxes.size();
+        const std::vector<IntVect> pshifts = period.shiftIntVect();
+
+        //
+        // Each pair is weighted once, when visiting its lower index, and
+        // the weight is stored in both directions so the graph is symmetric.
+        //
+        std::vector<std::map<int,long> > nbrs(N);
+        std::vector< std::pair<int,Box> > isects;
+        for (int i = 0; i < N; ++i)
+        {
+            for (const auto& iv : pshifts)
+            {
+                const Box bx = boxes[i] + iv;
+                boxes.intersections(amrex::grow(bx,1), isects);
+                for (const auto& is : isects)
+                {
+                    const int j = is.first;
+                    if (j <= i) continue;
+                    long area = 0;
+                    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                        const Box face = amrex::grow(bx,idim,1) & boxes[j];
+                        if (face.ok()) area += face.numPts();
+                    }
+                    nbrs[i][j] += std::max(area, 1L);
+                }
+            }
+            for (const auto& kv : nbrs[i]) {
+                nbrs[kv.first][i] = kv.second;
+            }
+        }
+
+        BoxGraph g;
+        g.vwgt = wgts;
+        g.xadj.resize(N+1);
+        g.xadj[0] = 0;
+        for (int i = 0; i < N; ++i)
+        {
+            for (const auto& kv : nbrs[i]) {
+                g.adjncy.push_back(kv.first);
+                g.adjwgt.push_back(kv.second);
+            }
+            g.xadj[i+1] = g.adjncy.size();
+        }
+        return g;
+    }
+
+    //
+    // The subgraph of the vertices v with part[v] == p.  ids maps the
+    // subgraph vertices back to g.
+    //
+    BoxGraph
+    SubGraph (const BoxGraph& g, const std::vector<int>& part, int p, std::vector<int>& ids)
+    {
+        const int n = g.size();
+        std::vector<int> local(n,-1);
+        ids.clear();
+        for (int v = 0; v < n; ++v) {
+            if (part[v] == p) {
+                local[v] = ids.size();
+                ids.push_back(v);
+            }
+        }
+        BoxGraph sg;
+        sg.xadj.reserve(ids.size()+1);
+        sg.xadj.push_back(0);
+        for (int v : ids)
+        {
+            sg.vwgt.push_back(g.vwgt[v]);
+            for (int e = g.xadj[v]; e < g.xadj[v+1]; ++e)
+            {
+                const int u = local[g.adjncy[e]];
+                if (u >= 0) {
+                    sg.adjncy.push_back(u);
+                    sg.adjwgt.push_back(g.adjwgt[e]);
+                }
+            }
+            sg.xadj.push_back(sg.adjncy.size());
+        }
+        return sg;
+    }
+
+    long
+    EdgeCut (const BoxGraph& g, const std::vector<int>& part)
+    {
+        long cut = 0;
+        for (int v = 0, n = g.size(); v < n; ++v) {
+            for (int e = g.xadj[v]; e < g.xadj[v+1]; ++e) {
+                if (part[g.adjncy[e]] != part[v]) cut += g.adjwgt[e];
+            }
+        }
+        return cut/2;
+    }
+
+    //
+    // Heavy edge matching.  Returns false if the graph hardly shrinks.
+    //
+    bool
+    CoarsenGraph (const BoxGraph& g, long maxvwgt, BoxGraph& cg, std::vector<int>& cmap)
+    {
+        const int n = g.size();
+
+        std::vector<int> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&g] (int a, int b)
+                         { return g.xadj[a+1]-g.xadj[a] < g.xadj[b+1]-g.xadj[b]; });
+
+        std::vector<int> match(n,-1);
+        for (int v : order)
+        {
+            if (match[v] >= 0) continue;
+            int  best  = v;
+            long bestw = -1;
+            for (int e = g.xadj[v]; e < g.xadj[v+1]; ++e)
+            {
+                const int u = g.adjncy[e];
+                if (match[u] < 0 && g.adjwgt[e] > bestw && g.vwgt[v] + g.vwgt[u] <= maxvwgt) {
+                    best  = u;
+                    bestw = g.adjwgt[e];
+                }
+            }
+            match[v]    = best;
+            match[best] = v;
+        }
+
+        cmap.assign(n,-1);
+        std::vector<int> rep;
+        for (int v = 0; v < n; ++v) {
+            if (cmap[v] < 0) {
+                cmap[v] = cmap[match[v]] = rep.size();
+                rep.push_back(v);
+            }
+        }
+        const int nc = rep.size();
+
+        if (nc > 0.95*n) return false;
+
+        cg = BoxGraph();
+        cg.xadj.reserve(nc+1);
+        cg.xadj.push_back(0);
+        cg.vwgt.resize(nc);
+        std::vector<int> mark(nc,-1);
+        for (int c = 0; c < nc; ++c)
+        {
+            const int start = cg.adjncy.size();
+            const int v0 = rep[c];
+            const int v1 = match[v0];
+            cg.vwgt[c] = g.vwgt[v0] + ((v1 != v0) ? g.vwgt[v1] : 0);
+            for (int v : {v0, v1})
+            {
+                for (int e = g.xadj[v]; e < g.xadj[v+1]; ++e)
+                {
+                    const int cu = cmap[g.adjncy[e]];
+                    if (cu == c) continue;
+                    if (mark[cu] < start) {
+                        mark[cu] = cg.adjncy.size();
+                        cg.adjncy.push_back(cu);
+                        cg.adjwgt.push_back(g.adjwgt[e]);
+                    } else {
+                        cg.adjwgt[mark[cu]] += g.adjwgt[e];
+                    }
+                }
+                if (v1 == v0) break;
+            }
+            cg.xadj.push_back(cg.adjncy.size());
+        }
+        return true;
+    }
+
+    //
+    // Is a bisection with this cut and deviation from the target weight
+    // better than the best so far?  Balanced beats unbalanced.
+    //
+    bool
+    BetterBisection (long cut, long dev, long bestcut, long bestdev, long tol)
+    {
+        const bool ok = dev <= tol, bestok = bestdev <= tol;
+        if (ok != bestok) return ok;
+        if (ok) return cut < bestcut || (cut == bestcut && dev < bestdev);
+        return dev < bestdev;
+    }
+
+    //
+    // Fiduccia-Mattheyses refinement of a bisection.  target is the
+    // desired weight of side 0 and tol the allowed deviation.
+    //
+    void
+    RefineBisection (const BoxGraph& g, std::vector<int>& side, long target, long tol,
+                     int npasses = 8)
+    {
+        const int n = g.size();
+        const int maxstall = std::max(50, n/20);
+
+        long w0 = 0;
+        for (int v = 0; v < n; ++v) {
+            if (side[v] == 0) w0 += g.vwgt[v];
+        }
+
+        std::vector<long> gain(n);
+        std::vector<char> locked(n);
+        std::vector<int>  moved;
+
+        for (int pass = 0; pass < npasses; ++pass)
+        {
+            using GainPair = std::pair<long,int>;
+            std::priority_queue<GainPair> pq[2];
+            for (int v = 0; v < n; ++v)
+            {
+                gain[v] = 0;
+                for (int e = g.xadj[v]; e < g.xadj[v+1]; ++e) {
+                    gain[v] += (side[g.adjncy[e]] != side[v]) ? g.adjwgt[e] : -g.adjwgt[e];
+                }
+                pq[side[v]].push(GainPair(gain[v],v));
+            }
+            std::fill(locked.begin(), locked.end(), 0);
+            moved.clear();
+
+            long cut     = EdgeCut(g, side);
+            long bestcut = cut;
+            long bestdev = std::abs(w0-target);
+            int  bestlen = 0;
+            int  stall   = 0;
+
+            while (stall < maxstall)
+            {
+                int pick = -1;
+                for (int s = 0; s < 2; ++s)
+                {
+                    while (!pq[s].empty() && (locked[pq[s].top().second] ||
+                                              gain[pq[s].top().second] != pq[s].top().first)) {
+                        pq[s].pop();
+                    }
+                    if (pq[s].empty()) continue;
+                    const int  v   = pq[s].top().second;
+                    const long nw0 = (s == 0) ? w0 - g.vwgt[v] : w0 + g.vwgt[v];
+                    const long dev = std::abs(nw0-target);
+                    if (dev > tol && dev >= std::abs(w0-target)) continue;
+                    if (pick < 0 || gain[v] > gain[pq[pick].top().second]) pick = s;
+                }
+                if (pick < 0) break;
+
+                const int v = pq[pick].top().second;
+                pq[pick].pop();
+                locked[v] = 1;
+                side[v] = 1 - pick;
+                w0 += (pick == 0) ? -g.vwgt[v] : g.vwgt[v];
+                cut -= gain[v];
+                gain[v] = -gain[v];
+                moved.push_back(v);
+
+                for (int e = g.xadj[v]; e < g.xadj[v+1]; ++e)
+                {
+                    const int u = g.adjncy[e];
+                    gain[u] += (side[u] == pick) ? 2*g.adjwgt[e] : -2*g.adjwgt[e];
+                    if (!locked[u]) pq[side[u]].push(GainPair(gain[u],u));
+                }
+
+                const long dev = std::abs(w0-target);
+                if (BetterBisection(cut, dev, bestcut, bestdev, tol)) {
+                    bestcut = cut;
+                    bestdev = dev;
+                    bestlen = moved.size();
+                    stall = 0;
+                } else {
+                    ++stall;
+                }
+            }
+
+            // ---- undo the moves after the best point
+            for (int i = moved.size()-1; i >= bestlen; --i)
+            {
+                const int v = moved[i];
+                w0 += (side[v] == 0) ? -g.vwgt[v] : g.vwgt[v];
+                side[v] = 1 - side[v];
+            }
+
+            if (bestlen == 0) break;
+        }
+    }
+
+    //
+    // Grow side 0 from a few seeds, keep the best refined result.
+    //
+    void
+    InitialBisection (const BoxGraph& g, long target, long tol, std::vector<int>& side)
+    {
+        const int n = g.size();
+        const int ntries = std::min(n,4);
+
+        long bestcut = 0, bestdev = 0;
+        std::vector<int> s(n);
+        std::vector<long> conn(n);
+
+        for (int t = 0; t < ntries; ++t)
+        {
+            std::fill(s.begin(), s.end(), 1);
+            // ---- conn is the weight of edges to side 0 minus those to side 1
+            for (int v = 0; v < n; ++v) {
+                conn[v] = 0;
+                for (int e = g.xadj[v]; e < g.xadj[v+1]; ++e) {
+                    conn[v] -= g.adjwgt[e];
+                }
+            }
+
+            using GainPair = std::pair<long,int>;
+            std::priority_queue<GainPair> pq;
+            const int seed = (static_cast<long>(t)*n)/ntries;
+            pq.push(GainPair(conn[seed],seed));
+            int next = 0;  // ---- for disconnected graphs
+            long w0 = 0;
+            while (w0 < target)
+            {
+                int v = -1;
+                while (!pq.empty()) {
+                    const GainPair top = pq.top();
+                    pq.pop();
+                    if (s[top.second] == 1 && conn[top.second] == top.first) {
+                        v = top.second;
+                        break;
+                    }
+                }
+                if (v < 0) {
+                    while (next < n && s[next] == 0) ++next;
+                    if (next == n) break;
+                    v = next;
+                }
+                if (w0 + g.vwgt[v] - target > target - w0) break;
+                s[v] = 0;
+                w0 += g.vwgt[v];
+                for (int e = g.xadj[v]; e < g.xadj[v+1]; ++e)
+                {
+                    const int u = g.adjncy[e];
+                    if (s[u] == 1) {
+                        conn[u] += 2*g.adjwgt[e];
+                        pq.push(GainPair(conn[u],u));
+                    }
+                }
+            }
+
+            RefineBisection(g, s, target, tol, 4);
+
+            long sw0 = 0;
+            for (int v = 0; v < n; ++v) {
+                if (s[v] == 0) sw0 += g.vwgt[v];
+            }
+            const long cut = EdgeCut(g, s);
+            const long dev = std::abs(sw0-target);
+            if (t == 0 || BetterBisection(cut, dev, bestcut, bestdev, tol)) {
+                bestcut = cut;
+                bestdev = dev;
+                side = s;
+            }
+        }
+    }
+
+    void
+    MultilevelBisection (const BoxGraph& g, long target, long tol, std::vector<int>& side)
+    {
+        const int coarsen_to = 64;
+        const int n = g.size();
+
+        BoxGraph cg;
+        std::vector<int> cmap;
+        const long maxvwgt = std::max(1L, static_cast<long>(1.5*g.totalWeight()/coarsen_to));
+
+        if (n <= coarsen_to || !CoarsenGraph(g, maxvwgt, cg, cmap))
+        {
+            InitialBisection(g, target, tol, side);
+            return;
+        }
+
+        std::vector<int> cside;
+        MultilevelBisection(cg, target, tol, cside);
+
+        side.resize(n);
+        for (int v = 0; v < n; ++v) {
+            side[v] = cside[cmap[v]];
+        }
+        RefineBisection(g, side, target, tol);
+    }
+
+    //
+    // Partition g into frac.size() parts numbered from p0, part i
+    // getting a share of the weight proportional to frac[i].
+    //
+    void
+    PartitionGraph (const BoxGraph& g, const std::vector<Real>& frac, int p0, std::vector<int>& part)
+    {
+        const int n = g.size();
+        const int k = frac.size();
+        part.resize(n);
+
+        if (k == 1 || n == 0) {
+            std::fill(part.begin(), part.end(), p0);
+            return;
+        }
+
+        const int k0 = k/2;
+        const Real f0 = std::accumulate(frac.begin(), frac.begin()+k0, Real(0.0));
+        const Real f  = std::accumulate(frac.begin(), frac.end(), Real(0.0));
+        const long total  = g.totalWeight();
+        const long target = static_cast<long>(total*(f0/f) + 0.5);
+        const long tol    = std::max(1L, static_cast<long>(0.01*total/k));
+
+        std::vector<int> side;
+        MultilevelBisection(g, target, tol, side);
+
+        std::vector<int> ids, subpart;
+        for (int s = 0; s < 2; ++s)
+        {
+            const BoxGraph sg = SubGraph(g, side, s, ids);
+            const std::vector<Real> subfrac = (s == 0)
+                ? std::vector<Real>(frac.begin(), frac.begin()+k0)
+                : std::vector<Real>(frac.begin()+k0, frac.end());
+            PartitionGraph(sg, subfrac, (s == 0) ? p0 : p0+k0, subpart);
+            for (int i = 0, N = ids.size(); i < N; ++i) {
+                part[ids[i]] = subpart[i];
+            }
+        }
+    }
+}
+
+void
+DistributionMapping::GraphProcessorMapDoIt (const BoxArray&          boxes,
+                                            const std::vector<long>& wgts,
+                                            int                   /*   nprocs */,
+                                            bool                     sort,
+                                            const Periodicity&       period)
+{
+    if (flag_verbose_mapper) {
+        Print() << "DM: GraphProcessorMapDoIt called..." << std::endl;
+    }
+
+    BL_PROFILE("DistributionMapping::GraphProcessorMapDoIt()");
+
+    const int nprocs = ParallelContext::NProcsSub();
+    const int N = boxes.size();
+
+    //
+    // Group the ranks by node.
+    //
+    Vector<int> rank_node(nprocs);
+    if (node_size > 0) {
+        for (int i = 0; i < nprocs; ++i) {
+            rank_node[i] = i/node_size;
+        }
+    } else {
+        const Vector<int>& node_ids = machine::node_ids();
+        for (int i = 0; i < nprocs; ++i) {
+            rank_node[i] = node_ids[ParallelContext::local_to_global_rank(i)];
+        }
+    }
+    std::map<int,Vector<int> > node_map;
+    for (int i = 0; i < nprocs; ++i) {
+        node_map[rank_node[i]].push_back(i);
+    }
+    Vector<Vector<int> > node_ranks;
+    for (auto& kv : node_map) {
+        node_ranks.push_back(std::move(kv.second));
+    }
+    const int nnodes = node_ranks.size();
+
+    if (flag_verbose_mapper) {
+        Print() << "  (nprocs, nnodes) = (" << nprocs << ", " << nnodes << ")\n";
+    }
+
+    Vector<int> ord;
+    if (sort) {
+        LeastUsedCPUs(nprocs,ord);
+    } else {
+        ord.resize(nprocs);
+        std::iota(ord.begin(), ord.end(), 0);
+    }
+    Vector<int> rank_order(nprocs);
+    for (int i = 0; i < nprocs; ++i) {
+        rank_order[ord[i]] = i;
+    }
+
+    //
+    // Cut across nodes first so the heaviest edges stay on a node, then
+    // split each node's boxes over its ranks.
+    //
+    const BoxGraph g = MakeBoxGraph(boxes, wgts, period);
+
+    std::vector<Real> node_frac(nnodes);
+    for (int i = 0; i < nnodes; ++i) {
+        node_frac[i] = node_ranks[i].size();
+    }
+    std::vector<int> node_part;
+    PartitionGraph(g, node_frac, 0, node_part);
+
+    std::vector<int> rank_of_box(N);
+    std::vector<int> ids, local_part;
+    for (int inode = 0; inode < nnodes; ++inode)
+    {
+        Vector<int>& ranks = node_ranks[inode];
+        const int nr = ranks.size();
+
+        const BoxGraph sg = SubGraph(g, node_part, inode, ids);
+        PartitionGraph(sg, std::vector<Real>(nr,1.0), 0, local_part);
+
+        // ---- the heaviest part goes to the least used rank
+        std::vector<LIpair> LIpairV(nr);
+        for (int i = 0; i < nr; ++i) {
+            LIpairV[i] = LIpair(0,i);
+        }
+        for (int i = 0, M = ids.size(); i < M; ++i) {
+            LIpairV[local_part[i]].first += sg.vwgt[i];
+        }
+        if (sort) Sort(LIpairV, true);
+        std::sort(ranks.begin(), ranks.end(),
+                  [&rank_order] (int a, int b) { return rank_order[a] < rank_order[b]; });
+
+        Vector<int> part_rank(nr);
+        for (int i = 0; i < nr; ++i) {
+            part_rank[LIpairV[i].second] = ranks[i];
+        }
+        for (int i = 0, M = ids.size(); i < M; ++i)
+        {
+            const int rank = part_rank[local_part[i]];
+            rank_of_box[ids[i]] = rank;
+            m_ref->m_pmap[ids[i]] = ParallelContext::local_to_global_rank(rank);
+        }
+    }
+
+    if (verbose)
+    {
+        std::vector<long> rank_wgt(nprocs,0);
+        for (int i = 0; i < N; ++i) {
+            rank_wgt[rank_of_box[i]] += wgts[i];
+        }
+        const Real sum_wgt = std::accumulate(rank_wgt.begin(), rank_wgt.end(), 0.0);
+        const Real max_wgt = *std::max_element(rank_wgt.begin(), rank_wgt.end());
+
+        std::vector<int> box_node(N);
+        for (int i = 0; i < N; ++i) {
+            box_node[i] = rank_node[rank_of_box[i]];
+        }
+        const Real total_edge = std::accumulate(g.adjwgt.begin(), g.adjwgt.end(), 0.0)/2;
+        const long rank_cut = EdgeCut(g, rank_of_box);
+        const long node_cut = EdgeCut(g, box_node);
+        const Real scale = (total_edge > 0) ? 100./total_edge : 0.0;
+
+        amrex::Print() << "GRAPH efficiency: " << (sum_wgt/(nprocs*max_wgt))
+                       << ", edge cut: " << rank_cut << " (" << rank_cut*scale << "%)"
+                       << ", off-node: " << node_cut << " (" << node_cut*scale << "%)\n";
+    }
+}
+
+void
+DistributionMapping::GraphProcessorMap (const BoxArray& boxes,
+                                        int             nprocs)
+{
+    BL_ASSERT(boxes.size() > 0);
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(boxes.size());
+
+    if (boxes.size() < sfc_threshold*nprocs)
+    {
+        KnapSackProcessorMap(boxes,nprocs);
+    }
+    else
+    {
+        std::vector<long> wgts;
+
+        wgts.reserve(boxes.size());
+
+	for (int i = 0, N = boxes.size(); i < N; ++i)
+        {
+            wgts.push_back(boxes[i].volume());
+        }
+
+        GraphProcessorMapDoIt(boxes,wgts,nprocs);
+    }
+}
+
+void
+DistributionMapping::GraphProcessorMap (const BoxArray&          boxes,
+                                        const std::vector<long>& wgts,
+                                        int                      nprocs,
+                                        bool                     sort,
+                                        const Periodicity&       period)
+{
+    BL_ASSERT(boxes.size() > 0);
+    BL_ASSERT(boxes.size() == static_cast<int>(wgts.size()));
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(wgts.size());
+
+    if (boxes.size() < sfc_threshold*nprocs)
+    {
+        KnapSackProcessorMap(wgts,nprocs);
+    }
+    else
+    {
+        GraphProcessorMapDoIt(boxes,wgts,nprocs,sort,period);
+    }
+}
+
+namespace
+{
+    //
+    // Integer weights for the processor maps, with the largest cost at 1e9
+    // and every weight at least 1.
+    //
+    Vector<long>
+    ScaleCosts (const Vector<Real>& rcost)
+    {
+        Vector<long> cost(rcost.size());
+
+        Real wmax = *std::max_element(rcost.begin(), rcost.end());
+        Real scale = (wmax == 0) ? 1.e9 : 1.e9/wmax;
+
+        for (int i = 0; i < rcost.size(); ++i) {
+            cost[i] = long(rcost[i]*scale) + 1L;
+        }
+
+        return cost;
+    }
+}
+
 DistributionMapping
 DistributionMapping::makeKnapSack (const Vector<Real>& rcost)
 {
@@ -1334,14 +1991,7 @@ DistributionMapping::makeKnapSack (const Vector<Real>& rcost)
 
     DistributionMapping r;
 
-    Vector<long> cost(rcost.size());
-
-    Real wmax = *std::max_element(rcost.begin(), rcost.end());
-    Real scale = (wmax == 0) ? 1.e9 : 1.e9/wmax;
-
-    for (int i = 0; i < rcost.size(); ++i) {
-        cost[i] = long(rcost[i]*scale) + 1L;
-    }
+    const Vector<long> cost = ScaleCosts(rcost);
 
     int nprocs = ParallelContext::NProcsSub();
     Real eff;
@@ -1459,6 +2109,69 @@ DistributionMapping::makeSFC (const MultiFab& weight, bool sort)
     return r;
 }
 
+DistributionMapping
+DistributionMapping::makeSFC (const Vector<Real>& rcost, const BoxArray& ba, bool sort)
+{
+    BL_PROFILE("makeSFC");
+
+    DistributionMapping r;
+
+    const Vector<long> cost = ScaleCosts(rcost);
+
+    int nprocs = ParallelContext::NProcsSub();
+
+    r.SFCProcessorMap(ba, cost, nprocs, sort);
+
+    return r;
+}
+
+DistributionMapping
+DistributionMapping::makeGraph (const MultiFab& weight, bool sort, const Periodicity& period)
+{
+    DistributionMapping r;
+
+    Vector<long> cost(weight.size());
+#ifdef BL_USE_MPI
+    {
+	Vector<Real> rcost(cost.size(), 0.0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	for (MFIter mfi(weight); mfi.isValid(); ++mfi) {
+	    int i = mfi.index();
+	    rcost[i] = weight[mfi].sum(mfi.validbox(),0);
+	}
+
+	ParallelAllReduce::Sum(&rcost[0], rcost.size(), ParallelContext::CommunicatorSub());
+
+	cost = ScaleCosts(rcost);
+    }
+#endif
+
+    int nprocs = ParallelContext::NProcsSub();
+
+    r.GraphProcessorMap(weight.boxArray(), cost, nprocs, sort, period);
+
+    return r;
+}
+
+DistributionMapping
+DistributionMapping::makeGraph (const Vector<Real>& rcost, const BoxArray& ba, bool sort,
+                                const Periodicity& period)
+{
+    BL_PROFILE("makeGraph");
+
+    DistributionMapping r;
+
+    const Vector<long> cost = ScaleCosts(rcost);
+
+    int nprocs = ParallelContext::NProcsSub();
+
+    r.GraphProcessorMap(ba, cost, nprocs, sort, period);
+
+    return r;
+}
+
 std::vector<std::vector<int> >
 DistributionMapping::makeSFC (const BoxArray& ba, bool use_box_vol)
 {
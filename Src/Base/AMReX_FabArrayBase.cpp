@@ -3,6 +3,7 @@
 #include <AMReX_FabArrayBase.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_Utility.H>
+#include <AMReX_ParallelContext.H>
 #include <AMReX_Geometry.H>
 #include <AMReX_FArrayBox.H>
 
@@ -24,6 +25,7 @@ namespace amrex {
 // Set default values in Initialize()!!!
 //
 int     FabArrayBase::MaxComp;
+bool    FabArrayBase::use_persistent_comm;
 
 #if defined(AMREX_USE_GPU) && defined(AMREX_USE_GPU_PRAGMA)
 
@@ -78,6 +80,9 @@ namespace
 {
     Arena* the_fa_arena = nullptr;
     bool initialized = false;
+    // The persistent FillBoundary requests on persistent_base_comm use persistent_comm.
+    MPI_Comm persistent_base_comm = MPI_COMM_NULL;
+    MPI_Comm persistent_comm      = MPI_COMM_NULL;
 }
 
 void
@@ -90,6 +95,7 @@ FabArrayBase::Initialize ()
     // Set default values here!!!
     //
     FabArrayBase::MaxComp           = 25;
+    FabArrayBase::use_persistent_comm = false;
 
     ParmParse pp("fabarray");
 
@@ -111,6 +117,7 @@ FabArrayBase::Initialize ()
     }
 
     pp.query("maxcomp",             FabArrayBase::MaxComp);
+    pp.query("use_persistent_comm", FabArrayBase::use_persistent_comm);
 
     if (MaxComp < 1) {
         MaxComp = 1;
@@ -122,6 +129,16 @@ FabArrayBase::Initialize ()
         the_fa_arena = The_Pinned_Arena();
     }
 
+#ifdef BL_USE_MPI
+    //
+    // A persistent request keeps its tag for as long as it lives, while the
+    // tags of the other messages wrap around.  So the persistent requests
+    // get a communicator of their own.
+    //
+    persistent_base_comm = ParallelContext::CommunicatorAll();
+    BL_MPI_REQUIRE( MPI_Comm_dup(persistent_base_comm, &persistent_comm) );
+#endif
+
     amrex::ExecOnFinalize(FabArrayBase::Finalize);
 
 #ifdef AMREX_MEM_PROFILING
@@ -992,6 +1009,20 @@ FabArrayBase::FB::~FB ()
     delete m_RcvTags;
 }
 
+FabArrayBase::FB::PersistentComm::~PersistentComm ()
+{
+#ifdef BL_USE_MPI
+    for (auto& req : m_send_reqs) {
+        if (req != MPI_REQUEST_NULL) MPI_Request_free(&req);
+    }
+    for (auto& req : m_recv_reqs) {
+        if (req != MPI_REQUEST_NULL) MPI_Request_free(&req);
+    }
+#endif
+    if (m_the_send_data) amrex::The_FA_Arena()->free(m_the_send_data);
+    if (m_the_recv_data) amrex::The_FA_Arena()->free(m_the_recv_data);
+}
+
 void
 FabArrayBase::flushFB (bool no_assertion) const
 {
@@ -1409,9 +1440,22 @@ FabArrayBase::Finalize ()
 
     the_fa_arena = nullptr;
 
+#ifdef BL_USE_MPI
+    if (persistent_comm != MPI_COMM_NULL) {
+        BL_MPI_REQUIRE( MPI_Comm_free(&persistent_comm) );
+    }
+    persistent_base_comm = MPI_COMM_NULL;
+#endif
+
     initialized = false;
 }
 
+MPI_Comm
+FabArrayBase::PersistentCommunicator (MPI_Comm comm) noexcept
+{
+    return (comm == persistent_base_comm) ? persistent_comm : MPI_COMM_NULL;
+}
+
 const FabArrayBase::TileArray* 
 FabArrayBase::getTileArray (const IntVect& tilesize) const
 {
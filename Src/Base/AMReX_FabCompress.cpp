@@ -0,0 +1,399 @@
+
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <AMReX.H>
+#include <AMReX_FabConv.H>
+#include <AMReX_FabCompress.H>
+
+namespace amrex {
+namespace FabCompress {
+
+namespace
+{
+    enum Method : unsigned char {
+        Stored     = 0,  //!< ---- the raw bytes
+        ShuffleLZ  = 1,  //!< ---- XOR delta and byte shuffled, then LZ coded
+        QuantizeLZ = 2   //!< ---- quantized, delta and varint coded, then LZ coded
+    };
+
+    constexpr int  HashLog   = 16;
+    constexpr long MinMatch  = 4;
+    constexpr long MaxOffset = 1L << 24;
+    //
+    // Larger ranges could lose integer precision in the quantized values.
+    //
+    constexpr double MaxQuantizedRange = 1.0e15;
+
+    //
+    // The block sizes are stored little endian so any host can read them.
+    //
+    void
+    PutInt64 (std::int64_t v, Vector<char>& out)
+    {
+        const std::uint64_t u = static_cast<std::uint64_t>(v);
+        for (int b = 0; b < 8; ++b) {
+            out.push_back(static_cast<char>((u >> (8 * b)) & 0xff));
+        }
+    }
+
+    std::int64_t
+    GetInt64 (const char* p)
+    {
+        std::uint64_t u = 0;
+        for (int b = 0; b < 8; ++b) {
+            u |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[b])) << (8 * b);
+        }
+        return static_cast<std::int64_t>(u);
+    }
+
+    void
+    PutVarint (std::uint64_t v, Vector<char>& out)
+    {
+        while (v >= 0x80) {
+            out.push_back(static_cast<char>((v & 0x7f) | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<char>(v));
+    }
+
+    std::uint64_t
+    GetVarint (const unsigned char*& p, const unsigned char* end)
+    {
+        std::uint64_t v = 0;
+        for (int shift = 0; ; shift += 7) {
+            if (p >= end || shift > 63) {
+                amrex::Abort("FabCompress: corrupt compressed block");
+            }
+            const unsigned char c = *p++;
+            v |= static_cast<std::uint64_t>(c & 0x7f) << shift;
+            if ((c & 0x80) == 0) {
+                break;
+            }
+        }
+        return v;
+    }
+
+    std::uint32_t
+    Read32 (const unsigned char* p)
+    {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    //
+    // A greedy LZ77 coder with one hash probe per position.  The stream
+    // is a sequence of (literal length, literals, match length, offset)
+    // with lengths and offsets varint coded, ending with a literal run.
+    //
+    void
+    LZEncode (const unsigned char* in, long n, Vector<char>& out)
+    {
+        Vector<long> table(1 << HashLog, -1);
+        long i = 0, anchor = 0;
+        while (i + MinMatch <= n) {
+            const std::uint32_t seq = Read32(in + i);
+            const std::uint32_t h = (seq * 2654435761u) >> (32 - HashLog);
+            const long cand = table[h];
+            table[h] = i;
+            if (cand >= 0 && i - cand <= MaxOffset && Read32(in + cand) == seq) {
+                long len = MinMatch;
+                while (i + len < n && in[cand + len] == in[i + len]) {
+                    ++len;
+                }
+                PutVarint(i - anchor, out);
+                out.insert(out.end(), in + anchor, in + i);
+                PutVarint(len - MinMatch, out);
+                PutVarint(i - cand, out);
+                i += len;
+                anchor = i;
+            } else {
+                // ---- skip faster through data that does not match
+                i += 1 + ((i - anchor) >> 6);
+            }
+        }
+        PutVarint(n - anchor, out);
+        out.insert(out.end(), in + anchor, in + n);
+    }
+
+    void
+    LZDecode (const unsigned char* p, const unsigned char* end, unsigned char* out, long n)
+    {
+        long o = 0;
+        while (true) {
+            const std::uint64_t nlit = GetVarint(p, end);
+            if (nlit > static_cast<std::uint64_t>(n - o) ||
+                nlit > static_cast<std::uint64_t>(end - p))
+            {
+                amrex::Abort("FabCompress: corrupt literal run");
+            }
+            std::memcpy(out + o, p, nlit);
+            p += nlit;
+            o += nlit;
+            if (o == n) {
+                break;
+            }
+            const std::uint64_t len = GetVarint(p, end) + MinMatch;
+            const std::uint64_t off = GetVarint(p, end);
+            if (off == 0 || off > static_cast<std::uint64_t>(o) ||
+                len > static_cast<std::uint64_t>(n - o))
+            {
+                amrex::Abort("FabCompress: corrupt match");
+            }
+            // ---- the source and destination may overlap
+            const unsigned char* src = out + o - off;
+            for (std::uint64_t k = 0; k < len; ++k) {
+                out[o + k] = src[k];
+            }
+            o += len;
+        }
+    }
+
+    //
+    // XOR each value with the previous one and group byte b of every
+    // result together.  For smooth data the sign and exponent bytes are
+    // then mostly zero, which the LZ coder handles well.  This works on
+    // the bytes as they are in memory, so the decoded bytes are in the
+    // format of the writer whatever the format of the reader.
+    //
+    void
+    Shuffle (const Real* v, long n, Vector<unsigned char>& out)
+    {
+        const int s = sizeof(Real);
+        out.resize(n * s);
+        const unsigned char* in = reinterpret_cast<const unsigned char*>(v);
+        unsigned char prev[sizeof(Real)] = { 0 };
+        for (long j = 0; j < n; ++j) {
+            for (int b = 0; b < s; ++b) {
+                const unsigned char c = in[j * s + b];
+                out[b * n + j] = c ^ prev[b];
+                prev[b] = c;
+            }
+        }
+    }
+
+    //
+    // The inverse of Shuffle for values of s bytes each.
+    //
+    void
+    Unshuffle (const unsigned char* in, long n, int s, unsigned char* out)
+    {
+        Vector<unsigned char> prev(s, 0);
+        for (long j = 0; j < n; ++j) {
+            for (int b = 0; b < s; ++b) {
+                prev[b] ^= in[b * n + j];
+                out[j * s + b] = prev[b];
+            }
+        }
+    }
+
+    //
+    // Returns false if the data cannot be quantized within errorBound.
+    //
+    bool
+    QuantizeChunk (const Real* v, long n, Real errorBound, Vector<char>& out)
+    {
+        if ( ! (errorBound > 0)) {
+            return false;
+        }
+        Real vmin = std::numeric_limits<Real>::max();
+        Real vmax = std::numeric_limits<Real>::lowest();
+        for (long j = 0; j < n; ++j) {
+            if ( ! std::isfinite(v[j])) {
+                return false;
+            }
+            vmin = std::min(vmin, v[j]);
+            vmax = std::max(vmax, v[j]);
+        }
+        const Real step = 2 * errorBound;
+        if ( ! std::isfinite(step) ||
+             (static_cast<double>(vmax) - static_cast<double>(vmin)) / step > MaxQuantizedRange)
+        {
+            return false;
+        }
+
+        Vector<char> codes;
+        codes.reserve(2 * n);
+        std::int64_t prev = 0;
+        for (long j = 0; j < n; ++j) {
+            const std::int64_t q = static_cast<std::int64_t>(std::floor((v[j] - vmin) / step + 0.5));
+            // ---- check the value the reader will reconstruct
+            const Real r = vmin + static_cast<Real>(q) * step;
+            if (std::abs(r - v[j]) > errorBound) {
+                return false;
+            }
+            const std::int64_t d = q - prev;
+            prev = q;
+            PutVarint((static_cast<std::uint64_t>(d) << 1) ^ static_cast<std::uint64_t>(d >> 63), codes);
+        }
+
+        const char* pmin  = reinterpret_cast<const char*>(&vmin);
+        const char* pstep = reinterpret_cast<const char*>(&step);
+        out.insert(out.end(), pmin, pmin + sizeof(Real));
+        out.insert(out.end(), pstep, pstep + sizeof(Real));
+        PutInt64(codes.size(), out);
+        LZEncode(reinterpret_cast<const unsigned char*>(codes.data()), codes.size(), out);
+        return true;
+    }
+
+    void
+    DequantizeChunk (const unsigned char* p, const unsigned char* end,
+                     const RealDescriptor& rd, Real* v, long n)
+    {
+        const int s = rd.numBytes();
+        if (end - p < static_cast<long>(2 * s + sizeof(std::int64_t))) {
+            amrex::Abort("FabCompress: corrupt quantized chunk");
+        }
+        Vector<unsigned char> raw(p, p + 2 * s);
+        Real range[2];
+        RealDescriptor::convertToNativeFormat(range, 2, raw.data(), rd);
+        const Real vmin = range[0];
+        const Real step = range[1];
+        p += 2 * s;
+        const std::int64_t ncodes = GetInt64(reinterpret_cast<const char*>(p));
+        p += sizeof(std::int64_t);
+
+        Vector<unsigned char> codes(ncodes);
+        LZDecode(p, end, codes.data(), ncodes);
+
+        const unsigned char* c = codes.data();
+        const unsigned char* cend = c + ncodes;
+        std::int64_t q = 0;
+        for (long j = 0; j < n; ++j) {
+            const std::uint64_t z = GetVarint(c, cend);
+            q += static_cast<std::int64_t>((z >> 1) ^ (~(z & 1) + 1));
+            v[j] = vmin + static_cast<Real>(q) * step;
+        }
+    }
+
+    void
+    CompressChunk (const Real* v, long n, int codec, Real errorBound, Vector<char>& out)
+    {
+        const long rawBytes = n * sizeof(Real);
+        out.clear();
+
+        bool done = false;
+        if (codec == Quantize) {
+            out.push_back(QuantizeLZ);
+            done = QuantizeChunk(v, n, errorBound, out);
+        }
+        if ( ! done) {
+            out.clear();
+            out.push_back(ShuffleLZ);
+            Vector<unsigned char> shuffled;
+            Shuffle(v, n, shuffled);
+            LZEncode(shuffled.data(), rawBytes, out);
+        }
+        if (static_cast<long>(out.size()) > rawBytes + 1) {
+            out.clear();
+            out.push_back(Stored);
+            const char* p = reinterpret_cast<const char*>(v);
+            out.insert(out.end(), p, p + rawBytes);
+        }
+    }
+
+    void
+    DecompressChunk (const char* in, long nbytes, const RealDescriptor& rd, Real* v, long n)
+    {
+        const long rawBytes = n * rd.numBytes();
+        if (nbytes < 1) {
+            amrex::Abort("FabCompress: empty chunk");
+        }
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(in) + 1;
+        const unsigned char* end = reinterpret_cast<const unsigned char*>(in) + nbytes;
+        switch (static_cast<unsigned char>(in[0]))
+        {
+        case Stored:
+        {
+            if (end - p != rawBytes) {
+                amrex::Abort("FabCompress: bad stored chunk size");
+            }
+            Vector<unsigned char> raw(p, end);
+            RealDescriptor::convertToNativeFormat(v, n, raw.data(), rd);
+            break;
+        }
+        case ShuffleLZ:
+        {
+            Vector<unsigned char> shuffled(rawBytes), raw(rawBytes);
+            LZDecode(p, end, shuffled.data(), rawBytes);
+            Unshuffle(shuffled.data(), n, rd.numBytes(), raw.data());
+            RealDescriptor::convertToNativeFormat(v, n, raw.data(), rd);
+            break;
+        }
+        case QuantizeLZ:
+            DequantizeChunk(p, end, rd, v, n);
+            break;
+        default:
+            amrex::Abort("FabCompress: unknown chunk method");
+        }
+    }
+}
+
+void
+Compress (const Real* data, long n, int codec, Real errorBound, Vector<char>& out)
+{
+    const long nChunks = (n + ChunkSize - 1) / ChunkSize;
+    Vector<Vector<char> > chunks(nChunks);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (long ic = 0; ic < nChunks; ++ic) {
+        const long begin = ic * ChunkSize;
+        CompressChunk(data + begin, std::min(ChunkSize, n - begin), codec, errorBound, chunks[ic]);
+    }
+
+    PutInt64(n, out);
+    PutInt64(nChunks, out);
+    for (long ic = 0; ic < nChunks; ++ic) {
+        PutInt64(chunks[ic].size(), out);
+    }
+    for (long ic = 0; ic < nChunks; ++ic) {
+        out.insert(out.end(), chunks[ic].begin(), chunks[ic].end());
+    }
+}
+
+void
+Decompress (const char* in, long nbytes, const RealDescriptor& rd, Real* data, long n)
+{
+    const long headerBytes = 2 * sizeof(std::int64_t);
+    if (nbytes < headerBytes || NumValues(in) != n) {
+        amrex::Abort("FabCompress::Decompress: block does not match the FAB size");
+    }
+    const long nChunks = GetInt64(in + sizeof(std::int64_t));
+    if (nChunks != (n + ChunkSize - 1) / ChunkSize ||
+        nbytes < headerBytes + nChunks * static_cast<long>(sizeof(std::int64_t)))
+    {
+        amrex::Abort("FabCompress::Decompress: corrupt chunk table");
+    }
+
+    Vector<long> offset(nChunks + 1);
+    offset[0] = headerBytes + nChunks * sizeof(std::int64_t);
+    for (long ic = 0; ic < nChunks; ++ic) {
+        offset[ic + 1] = offset[ic] + GetInt64(in + headerBytes + ic * sizeof(std::int64_t));
+    }
+    if (offset[nChunks] > nbytes) {
+        amrex::Abort("FabCompress::Decompress: block is truncated");
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (long ic = 0; ic < nChunks; ++ic) {
+        const long begin = ic * ChunkSize;
+        DecompressChunk(in + offset[ic], offset[ic + 1] - offset[ic], rd,
+                        data + begin, std::min(ChunkSize, n - begin));
+    }
+}
+
+std::int64_t
+NumValues (const char* in)
+{
+    return GetInt64(in);
+}
+
+}
+}
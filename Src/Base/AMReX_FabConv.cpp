@@ -3,6 +3,8 @@
 #include <cstdlib>
 #include <limits>
 #include <cstring>
+#include <cstdint>
+#include <algorithm>
 
 #include <AMReX.H>
 #include <AMReX_FabConv.H>
@@ -904,6 +906,139 @@ operator>> (std::istream&   is,
     return is;
 }
 
+//
+// Fast conversions between IEEE 32 and 64-bit reals in either byte order.
+// Each item is loaded as an unsigned integer, byte swapped if needed,
+// converted by the hardware and stored, in loops the compiler can
+// vectorize.  Unlike the bit-by-bit conversion, denormals are converted
+// exactly, so there is nothing to fix afterwards.
+//
+
+namespace {
+
+template <class T> struct ieee_bits;
+template <> struct ieee_bits<float>  { typedef std::uint32_t type; };
+template <> struct ieee_bits<double> { typedef std::uint64_t type; };
+
+AMREX_FORCE_INLINE
+std::uint32_t
+byte_swap (std::uint32_t x) noexcept
+{
+    return ((x & 0x000000FFu) << 24) | ((x & 0x0000FF00u) <<  8)
+        |  ((x & 0x00FF0000u) >>  8) | ((x & 0xFF000000u) >> 24);
+}
+
+AMREX_FORCE_INLINE
+std::uint64_t
+byte_swap (std::uint64_t x) noexcept
+{
+    return (std::uint64_t(byte_swap(std::uint32_t(x))) << 32)
+        |   std::uint64_t(byte_swap(std::uint32_t(x >> 32)));
+}
+
+template <class TI, class TO, bool SwapIn, bool SwapOut>
+void
+ieee_convert (char* AMREX_RESTRICT out, const char* AMREX_RESTRICT in, long nitems)
+{
+    typedef typename ieee_bits<TI>::type UI;
+    typedef typename ieee_bits<TO>::type UO;
+    AMREX_PRAGMA_SIMD
+    for (long i = 0; i < nitems; ++i)
+    {
+        UI ui;
+        std::memcpy(&ui, in+i*sizeof(UI), sizeof(UI));
+        if (SwapIn) ui = byte_swap(ui);
+        TI x;
+        std::memcpy(&x, &ui, sizeof(TI));
+        const TO y = static_cast<TO>(x);
+        UO uo;
+        std::memcpy(&uo, &y, sizeof(TO));
+        if (SwapOut) uo = byte_swap(uo);
+        std::memcpy(out+i*sizeof(UO), &uo, sizeof(UO));
+    }
+}
+
+template <class TI, class TO>
+void
+ieee_convert (void* out, const void* in, long nitems, bool swap_in, bool swap_out)
+{
+    char*       pout = static_cast<char*>(out);
+    const char* pin  = static_cast<const char*>(in);
+    if (swap_in) {
+        if (swap_out) {
+            ieee_convert<TI,TO,true,true>(pout, pin, nitems);
+        } else {
+            ieee_convert<TI,TO,true,false>(pout, pin, nitems);
+        }
+    } else {
+        if (swap_out) {
+            ieee_convert<TI,TO,false,true>(pout, pin, nitems);
+        } else {
+            ieee_convert<TI,TO,false,false>(pout, pin, nitems);
+        }
+    }
+}
+
+//
+// Is rd an IEEE 32 or 64-bit format in the native or the reversed byte
+// order?  If so, swapped tells which.
+//
+bool
+ieee_format (const RealDescriptor& rd, bool& swapped)
+{
+    const int nb = rd.numBytes();
+    const long* fmt = rd.format();
+    const int* ord = rd.order();
+    const int* native;
+    if (nb == 4 && std::equal(fmt, fmt+8, FPC::ieee_float)) {
+        native = FPC::Native32RealDescriptor().order();
+    } else if (nb == 8 && std::equal(fmt, fmt+8, FPC::ieee_double)) {
+        native = FPC::Native64RealDescriptor().order();
+    } else {
+        return false;
+    }
+
+    bool same = true, reversed = true;
+    for (int i = 0; i < nb; ++i) {
+        same     = same     && (ord[i] == native[i]);
+        reversed = reversed && (ord[i] == nb+1-native[i]);
+    }
+    swapped = reversed;
+    return same || reversed;
+}
+
+//
+// Returns false, having done nothing, if it's not a conversion between
+// IEEE formats.
+//
+bool
+PD_convert_ieee (void*                 out,
+                 const void*           in,
+                 long                  nitems,
+                 const RealDescriptor& ord,
+                 const RealDescriptor& ird)
+{
+    bool swap_out, swap_in;
+    if (!ieee_format(ord, swap_out) || !ieee_format(ird, swap_in)) return false;
+
+    if (ird.numBytes() == 4) {
+        if (ord.numBytes() == 4) {
+            ieee_convert<float,float>(out, in, nitems, swap_in, swap_out);
+        } else {
+            ieee_convert<float,double>(out, in, nitems, swap_in, swap_out);
+        }
+    } else {
+        if (ord.numBytes() == 4) {
+            ieee_convert<double,float>(out, in, nitems, swap_in, swap_out);
+        } else {
+            ieee_convert<double,double>(out, in, nitems, swap_in, swap_out);
+        }
+    }
+    return true;
+}
+
+}
+
 static
 void
 PD_convert (void*                 out,
@@ -922,23 +1057,14 @@ PD_convert (void*                 out,
         BL_ASSERT(int(n) == nitems);
         memcpy(out, in, n*ord.numBytes());
     }
+    else if (boffs == 0 && ! onescmp && PD_convert_ieee(out, in, nitems, ord, ird))
+    {
+        // Done.
+    }
     else if (ord.formatarray() == ird.formatarray() && boffs == 0 && ! onescmp) {
         permute_real_word_order(out, in, nitems,
                                 ord.order(), ird.order(), ord.numBytes());
     }
-    else if (ird == FPC::NativeRealDescriptor() && ord == FPC::Native32RealDescriptor()) {
-      auto rIn = static_cast<const char*>(in);
-      auto rOut= static_cast<char*>(out);
-      for(long i(0); i < nitems; ++i) {
-        Real x;
-        float y;
-        std::memcpy(&x, rIn, sizeof(Real));
-        y = x;
-        std::memcpy(rOut, &y, sizeof(float));
-        rOut += sizeof(float);
-        rIn += sizeof(Real);
-      }
-    }
     else
     {
         PD_fconvert(out, in, nitems, boffs, ord.format(), ord.order(),
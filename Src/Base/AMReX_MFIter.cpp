@@ -144,7 +144,9 @@ MFIter::MFIter (const BoxArray& ba, const DistributionMapping& dm, const MFItInf
     local_index_map(nullptr),
     tile_array(nullptr),
     local_tile_index_map(nullptr),
-    num_local_tiles(nullptr)
+    num_local_tiles(nullptr),
+    region(info.region),
+    region_nghost(info.region_nghost)
 {
 #ifdef _OPENMP
     if (dynamic) {
@@ -174,7 +176,9 @@ MFIter::MFIter (const FabArrayBase& fabarray_, const MFItInfo& info)
     local_index_map(nullptr),
     tile_array(nullptr),
     local_tile_index_map(nullptr),
-    num_local_tiles(nullptr)
+    num_local_tiles(nullptr),
+    region(info.region),
+    region_nghost(info.region_nghost)
 {
 #ifdef _OPENMP
     if (dynamic) {
@@ -235,6 +239,11 @@ MFIter::Initialize ()
     else
     {
 	const FabArrayBase::TileArray* pta = fabArray.getTileArray(tile_size);
+
+        if (region != MFItInfo::AllCells) {
+            buildRegionTileArray(*pta);
+            pta = m_region_ta.get();
+        }
 	
 	index_map            = &(pta->indexMap);
 	local_index_map      = &(pta->localIndexMap);
@@ -316,6 +325,52 @@ MFIter::Initialize ()
     }
 }
 
+void
+MFIter::buildRegionTileArray (const FabArrayBase::TileArray& ta)
+{
+    m_region_ta.reset(new FabArrayBase::TileArray);
+    FabArrayBase::TileArray& rta = *m_region_ta;
+
+    const int N = ta.indexMap.size();
+    int first = 0;  // first tile of the current fab in rta
+    for (int i = 0; i < N; ++i)
+    {
+        const int K = ta.indexMap[i];
+        if (i > 0 && K != ta.indexMap[i-1]) {
+            first = rta.indexMap.size();
+        }
+
+        // Tiles are cell-centered boxes even if the BoxArray is nodal.
+        const Box& tbx = ta.tileArray[i];
+        const Box& ibx = amrex::grow(fabArray.boxArray().getCellCenteredBox(K), -region_nghost);
+        const Box& isect = tbx & ibx;
+
+        BoxList bl;
+        if (region == MFItInfo::InteriorCells) {
+            if (isect.ok()) bl.push_back(isect);
+        } else if (isect.ok()) {
+            bl = amrex::boxDiff(tbx, isect);
+        } else {
+            bl.push_back(tbx);
+        }
+
+        for (const Box& bx : bl) {
+            rta.indexMap.push_back(K);
+            rta.localIndexMap.push_back(ta.localIndexMap[i]);
+            rta.localTileIndexMap.push_back(rta.indexMap.size()-1-first);
+            rta.numLocalTiles.push_back(0);
+            rta.tileArray.push_back(bx);
+        }
+
+        if (i == N-1 || ta.indexMap[i+1] != K) {
+            const int nt = rta.indexMap.size() - first;
+            for (int it = first; it < first+nt; ++it) {
+                rta.numLocalTiles[it] = nt;
+            }
+        }
+    }
+}
+
 Box 
 MFIter::tilebox () const noexcept
 { 
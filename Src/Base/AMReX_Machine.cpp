@@ -211,8 +211,11 @@ class Machine
         get_params();
         get_machine_envs();
         node_ids = get_node_ids();
+        shared_node_ids = flag_nersc_df ? node_ids : get_shared_node_ids();
     }
 
+    const Vector<int>& get_job_node_ids () const { return shared_node_ids; }
+
     // find a compact neighborhood of size rank_n in the current ParallelContext subgroup
     Vector<int> find_best_nbh (int nbh_rank_n, bool flag_local_ranks)
     {
@@ -320,6 +323,7 @@ class Machine
     bool flag_nersc_df;
     int my_node_id;
     Vector<int> node_ids;
+    Vector<int> shared_node_ids;
 
     NeighborhoodCache nbh_cache;
 
@@ -429,6 +433,26 @@ class Machine
         return ids;
     }
 
+    // get node IDs from the ranks that can share memory, the ID of a
+    // node is the lowest job rank on it
+    // this is collective over ALL ranks in the job
+    Vector<int> get_shared_node_ids ()
+    {
+        Vector<int> ids(ParallelDescriptor::NProcs(), 0);
+#ifdef BL_USE_MPI
+        MPI_Comm all_comm = ParallelContext::CommunicatorAll();
+        int my_rank;
+        MPI_Comm_rank(all_comm, &my_rank);
+        MPI_Comm node_comm;
+        MPI_Comm_split_type(all_comm, MPI_COMM_TYPE_SHARED, my_rank, MPI_INFO_NULL, &node_comm);
+        int node_id = my_rank;
+        MPI_Allreduce(MPI_IN_PLACE, &node_id, 1, MPI_INT, MPI_MIN, node_comm);
+        MPI_Comm_free(&node_comm);
+        ParallelAllGather::AllGather(node_id, ids.data(), all_comm);
+#endif
+        return ids;
+    }
+
     // do a local search starting at current node
     std::pair<Vector<int>, double>
     baseline_score(const Vector<int> & sg_node_ids, int nbh_rank_n)
@@ -588,4 +612,9 @@ Vector<int> find_best_nbh (int rank_n, bool flag_local_ranks) {
     return the_machine->find_best_nbh(rank_n, flag_local_ranks);
 }
 
+const Vector<int>& node_ids () {
+    AMREX_ASSERT(the_machine);
+    return the_machine->get_job_node_ids();
+}
+
 }}
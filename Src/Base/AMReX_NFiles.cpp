@@ -7,6 +7,7 @@ namespace amrex {
 
 int NFilesIter::currentDeciderIndex(-1);
 int NFilesIter::minDigits(5);
+bool NFilesIter::filePerProcess(false);
 
 
 NFilesIter::NFilesIter(int noutfiles, const std::string &fileprefix,
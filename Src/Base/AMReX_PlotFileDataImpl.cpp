@@ -1,8 +1,16 @@
 #include <algorithm>
+#include <limits>
+#include <streambuf>
+#include <istream>
 #include <AMReX_PlotFileDataImpl.H>
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_VisMF.H>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace amrex {
 
 namespace {
@@ -11,6 +19,29 @@ namespace {
         constexpr std::streamsize bl_ignore_max { 100000 };
         is.ignore(bl_ignore_max, '\n');
     }
+
+    // ---- an istream buffer over a memory mapped file
+    class MappedBuf
+        : public std::streambuf
+    {
+    public:
+        MappedBuf (char* p, long n) { setg(p, p, p+n); }
+    protected:
+        pos_type seekoff (off_type off, std::ios_base::seekdir dir,
+                          std::ios_base::openmode which) override
+        {
+            char* p = (dir == std::ios_base::beg) ? eback()
+                    : ((dir == std::ios_base::cur) ? gptr() : egptr());
+            p += off;
+            if (p < eback() || p > egptr()) return pos_type(off_type(-1));
+            setg(eback(), p, egptr());
+            return pos_type(off_type(p - eback()));
+        }
+        pos_type seekpos (pos_type pos, std::ios_base::openmode which) override
+        {
+            return seekoff(off_type(pos), std::ios_base::beg, which);
+        }
+    };
 }
 
 PlotFileDataImpl::PlotFileDataImpl (std::string const& plotfile_name)
@@ -96,7 +127,14 @@ PlotFileDataImpl::PlotFileDataImpl (std::string const& plotfile_name)
     }
 }
 
-PlotFileDataImpl::~PlotFileDataImpl () {}
+PlotFileDataImpl::~PlotFileDataImpl ()
+{
+    for (auto& kv : m_mapped_files) {
+        if (kv.second.data) {
+            munmap(kv.second.data, kv.second.size);
+        }
+    }
+}
 
 void
 PlotFileDataImpl::syncDistributionMap (PlotFileDataImpl const& src) noexcept
@@ -127,19 +165,151 @@ MultiFab
 PlotFileDataImpl::get (int level, std::string const& varname) noexcept
 {
     MultiFab mf(m_ba[level], m_dmap[level], 1, m_ngrow[level]);
+    int icomp = varIndex(varname);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        int gid = mfi.index();
+        FArrayBox& dstfab = mf[mfi];
+        std::unique_ptr<FArrayBox> srcfab(m_vismf[level]->readFAB(gid, icomp));
+        dstfab.copy(*srcfab);
+    }
+    return mf;
+}
+
+int
+PlotFileDataImpl::varIndex (std::string const& varname) const noexcept
+{
     auto r = std::find(std::begin(m_var_names), std::end(m_var_names), varname);
     if (r == std::end(m_var_names)) {
-        amrex::Abort("PlotFileDataImpl::get: varname not found "+varname);
+        amrex::Abort("PlotFileDataImpl: varname not found "+varname);
+    }
+    return std::distance(std::begin(m_var_names), r);
+}
+
+const PlotFileDataImpl::MappedFile&
+PlotFileDataImpl::mappedFile (std::string const& name) noexcept
+{
+    auto it = m_mapped_files.find(name);
+    if (it != m_mapped_files.end()) {
+        return it->second;
+    }
+
+    // ---- a null mapping means fall back to reading through VisMF
+    MappedFile& mfile = m_mapped_files[name];
+    int fd = open(name.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                mfile.data = static_cast<char*>(p);
+                mfile.size = st.st_size;
+            }
+        }
+        close(fd);
+    }
+    return mfile;
+}
+
+const FArrayBox&
+PlotFileDataImpl::getFab (int level, int gid, int icomp) noexcept
+{
+    const CacheKey key(level, gid, icomp);
+    auto it = m_cache_map.find(key);
+    if (it != m_cache_map.end()) {
+        m_cache.splice(m_cache.begin(), m_cache, it->second);
+        return *(m_cache.front().fab);
+    }
+
+    const VisMF& vismf = *m_vismf[level];
+    const MappedFile& mfile = mappedFile(vismf.fabFileName(gid));
+    std::unique_ptr<FArrayBox> fab;
+    if (mfile.data) {
+        MappedBuf buf(mfile.data, mfile.size);
+        std::istream is(&buf);
+        is.seekg(vismf.fabFileOffset(gid), std::ios::beg);
+        fab.reset(vismf.readFAB(is, gid, icomp));
     } else {
-        int icomp = std::distance(std::begin(m_var_names), r);
-        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
-            int gid = mfi.index();
-            FArrayBox& dstfab = mf[mfi];
-            std::unique_ptr<FArrayBox> srcfab(m_vismf[level]->readFAB(gid, icomp));
-            dstfab.copy(*srcfab);
+        fab.reset(m_vismf[level]->readFAB(gid, icomp));
+    }
+
+    m_cache_bytes += fab->nBytes();
+    m_cache.push_front(CacheEntry{key, std::move(fab)});
+    m_cache_map[key] = m_cache.begin();
+
+    // ---- never evict the fab just read
+    while (m_cache_bytes > m_cache_max_bytes && m_cache.size() > 1) {
+        const CacheEntry& lru = m_cache.back();
+        m_cache_bytes -= lru.fab->nBytes();
+        m_cache_map.erase(lru.key);
+        m_cache.pop_back();
+    }
+
+    return *(m_cache.front().fab);
+}
+
+const FArrayBox&
+PlotFileDataImpl::getFab (int level, int gid, std::string const& varname) noexcept
+{
+    return getFab(level, gid, varIndex(varname));
+}
+
+void
+PlotFileDataImpl::fill (FArrayBox& dest, int dcomp, int level, std::string const& varname) noexcept
+{
+    const int icomp = varIndex(varname);
+    const auto isects = m_ba[level].intersections(dest.box());
+    for (auto const& is : isects) {
+        const FArrayBox& src = getFab(level, is.first, icomp);
+        dest.copy(src, is.second, 0, is.second, dcomp, 1);
+    }
+}
+
+std::pair<Real,Real>
+PlotFileDataImpl::minMax (int level, int gid, std::string const& varname) noexcept
+{
+    const int icomp = varIndex(varname);
+    const VisMF& vismf = *m_vismf[level];
+    Real vmin = vismf.min(gid, icomp);
+    Real vmax = vismf.max(gid, icomp);
+    if (vmin > vmax) {  // ---- not in the header
+        const FArrayBox& fab = getFab(level, gid, icomp);
+        vmin = fab.min(m_ba[level][gid], 0);
+        vmax = fab.max(m_ba[level][gid], 0);
+    }
+    return std::make_pair(vmin, vmax);
+}
+
+std::pair<Real,Real>
+PlotFileDataImpl::minMax (int level, std::string const& varname) noexcept
+{
+    const int icomp = varIndex(varname);
+    const VisMF& vismf = *m_vismf[level];
+    Real vmin = vismf.min(icomp);
+    Real vmax = vismf.max(icomp);
+    if (vmin > vmax) {  // ---- no FabArray min and max in the header
+        vmin = std::numeric_limits<Real>::max();
+        vmax = std::numeric_limits<Real>::lowest();
+        for (int gid = 0; gid < m_ba[level].size(); ++gid) {
+            auto mm = minMax(level, gid, varname);
+            vmin = std::min(vmin, mm.first);
+            vmax = std::max(vmax, mm.second);
         }
     }
-    return mf;
+    return std::make_pair(vmin, vmax);
+}
+
+void
+PlotFileDataImpl::setCacheSize (long nbytes) noexcept
+{
+    m_cache_max_bytes = nbytes;
+}
+
+void
+PlotFileDataImpl::clearCache () noexcept
+{
+    m_cache_map.clear();
+    m_cache.clear();
+    m_cache_bytes = 0;
 }
 
 }
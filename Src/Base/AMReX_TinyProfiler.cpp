@@ -6,6 +6,9 @@
 #include <iomanip>
 #include <cmath>
 #include <set>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include <AMReX_TinyProfiler.H>
 #include <AMReX_ParallelDescriptor.H>
@@ -19,36 +22,164 @@
 
 namespace amrex {
 
-std::vector<std::string>          TinyProfiler::regionstack;
-std::deque<std::tuple<double,double,std::string*> > TinyProfiler::ttstack;
-std::map<std::string,std::map<std::string, TinyProfiler::Stats> > TinyProfiler::statsmap;
+struct TinyProfiler::ThreadData
+{
+    struct Frame
+    {
+        int fid;
+        double t0;      //!< wall time when the frame is pushed into the stack
+        double tchild;  //!< accumulated dt of children
+    };
+
+    Stats& getStats (int region, int f) noexcept {
+        if (static_cast<int>(stats.size()) <= region) stats.resize(region+1);
+        std::vector<Stats>& v = stats[region];
+        if (static_cast<int>(v.size()) <= f) v.resize(f+1);
+        return v[f];
+    }
+
+    std::vector<Frame> ttstack;
+    std::vector<std::vector<Stats> > stats;  //!< [region][function]
+    std::unordered_map<std::string,const FuncEntry*> func_cache;  //!< names this thread has interned
+    bool is_main = false;
+};
+
 double TinyProfiler::t_init = std::numeric_limits<double>::max();
 
 namespace {
-    std::set<std::string> improperly_nested_timers;
     static constexpr char mainregion[] = "main";
+
+    // Guards everything below except current_regions and the per-thread data.
+    std::mutex tp_mutex;
+
+    std::unordered_map<std::string,int> func_ids;
+    std::vector<const std::string*> func_names;
+
+    std::map<std::string,int> region_ids;
+    std::vector<std::string> region_names;
+    // The distinct region stacks seen so far.  Timers keep pointers to them.
+    std::set<std::vector<int> > region_stacks;
+    std::atomic<const std::vector<int>*> current_regions{nullptr};
+
+    std::vector<std::unique_ptr<TinyProfiler::ThreadData> > all_thread_data;
+    thread_local TinyProfiler::ThreadData* local_thread_data = nullptr;
+
+    std::set<std::string> improperly_nested_timers;
+
+    TinyProfiler::ThreadData& LocalThreadData () noexcept
+    {
+        if (local_thread_data == nullptr) {
+            std::lock_guard<std::mutex> lock(tp_mutex);
+            all_thread_data.emplace_back(new TinyProfiler::ThreadData);
+            local_thread_data = all_thread_data.back().get();
+        }
+        return *local_thread_data;
+    }
+
+    int RegionId (const std::string& regname)
+    {
+        auto it = region_ids.find(regname);
+        if (it != region_ids.end()) return it->second;
+        const int id = region_names.size();
+        region_ids.emplace(regname, id);
+        region_names.push_back(regname);
+        return id;
+    }
+
+    void SetCurrentRegions (const std::vector<int>& regs)
+    {
+        current_regions.store(&*region_stacks.insert(regs).first, std::memory_order_release);
+    }
+}
+
+const TinyProfiler::FuncEntry*
+TinyProfiler::Intern (const std::string& funcname) noexcept
+{
+    // Names built at run time miss the CallSite cache whenever they change.
+    // Each thread remembers the names it has seen, so only the first use of
+    // a name on a thread takes the lock; later uses cost one hash lookup.
+    std::unordered_map<std::string,const FuncEntry*>& cache = LocalThreadData().func_cache;
+    auto it = cache.find(funcname);
+    if (it != cache.end()) {
+        return it->second;
+    }
+
+    const FuncEntry* e;
+    {
+        std::lock_guard<std::mutex> lock(tp_mutex);
+        auto r = func_ids.emplace(funcname, static_cast<int>(func_names.size()));
+        if (r.second) {
+            func_names.push_back(&(r.first->first));
+        }
+        e = &*r.first;
+    }
+    cache.emplace(funcname, e);
+    return e;
+}
+
+const TinyProfiler::FuncEntry*
+TinyProfiler::Intern (CallSite& site, const char* funcname) noexcept
+{
+    // A string literal always has the same address, so this is usually
+    // just a pointer comparison.
+    const FuncEntry* e = site.entry.load(std::memory_order_acquire);
+    if (e && (site.literal.load(std::memory_order_relaxed) == funcname || e->first == funcname)) {
+        return e;
+    }
+    const FuncEntry* r = Intern(std::string(funcname));
+    if (e == nullptr) {
+        std::lock_guard<std::mutex> lock(tp_mutex);
+        site.literal.store(funcname, std::memory_order_relaxed);
+        site.entry.store(r, std::memory_order_release);
+    }
+    return r;
+}
+
+const TinyProfiler::FuncEntry*
+TinyProfiler::Intern (CallSite& site, const std::string& funcname) noexcept
+{
+    const FuncEntry* e = site.entry.load(std::memory_order_acquire);
+    if (e && e->first == funcname) {
+        return e;
+    }
+    const FuncEntry* r = Intern(funcname);
+    if (e == nullptr) {
+        site.entry.store(r, std::memory_order_release);
+    }
+    return r;
 }
 
 TinyProfiler::TinyProfiler (std::string funcname) noexcept
-    : fname(std::move(funcname))
+    : fentry(Intern(funcname)),
+      fid(fentry->second)
 {
     start();
 }
 
 TinyProfiler::TinyProfiler (std::string funcname, bool start_) noexcept
-    : fname(std::move(funcname))
+    : fentry(Intern(funcname)),
+      fid(fentry->second)
 {
     if (start_) start();
 }
 
 TinyProfiler::TinyProfiler (const char* funcname) noexcept
-    : fname(funcname)
+    : fentry(Intern(std::string(funcname))),
+      fid(fentry->second)
 {
     start();
 }
 
 TinyProfiler::TinyProfiler (const char* funcname, bool start_) noexcept
-    : fname(funcname)
+    : fentry(Intern(std::string(funcname))),
+      fid(fentry->second)
+{
+    if (start_) start();
+}
+
+TinyProfiler::TinyProfiler (CallSite& site, const std::string& funcname, bool start_) noexcept
+    : fentry(Intern(site, funcname)),
+      fid(fentry->second)
 {
     if (start_) start();
 }
@@ -61,25 +192,25 @@ TinyProfiler::~TinyProfiler ()
 void
 TinyProfiler::start () noexcept
 {
-#ifdef _OPENMP
-#pragma omp master
-#endif
-    if (stats.empty() && !regionstack.empty())
+    if (global_depth < 0)
     {
+        regions = current_regions.load(std::memory_order_acquire);
+        if (regions == nullptr) return;  // not initialized
+
+        tdata = &LocalThreadData();
+
 	double t = amrex::second();
 
-	ttstack.emplace_back(std::make_tuple(t, 0.0, &fname));
-	global_depth = ttstack.size();
+	tdata->ttstack.push_back(ThreadData::Frame{fid, t, 0.0});
+	global_depth = tdata->ttstack.size();
 
 #ifdef AMREX_USE_CUDA
-	nvtx_id = nvtxRangeStartA(fname.c_str());
+	nvtx_id = nvtxRangeStartA(fentry->first.c_str());
 #endif
 
-        for (auto const& region : regionstack)
+        for (int region : *regions)
         {
-            Stats& st = statsmap[region][fname];
-            ++st.depth;
-            stats.push_back(&st);
+            ++(tdata->getStats(region,fid).depth);
         }
     }
 }
@@ -87,58 +218,62 @@ TinyProfiler::start () noexcept
 void
 TinyProfiler::stop () noexcept
 {
-#ifdef _OPENMP
-#pragma omp master
-#endif
-    if (!stats.empty()) 
+    if (global_depth >= 0)
     {
 	double t = amrex::second();
 
+        std::vector<ThreadData::Frame>& ttstack = tdata->ttstack;
+
 	while (static_cast<int>(ttstack.size()) > global_depth) {
 	    ttstack.pop_back();
 	};
 
 	if (static_cast<int>(ttstack.size()) == global_depth)
 	{
-	    const std::tuple<double,double,std::string*>& tt = ttstack.back();
-	    
-	    // first: wall time when the pair is pushed into the stack
-	    // second: accumulated dt of children
-	    
-	    double dtin = t - std::get<0>(tt); // elapsed time since start() is called.
-	    double dtex = dtin - std::get<1>(tt);
+	    const ThreadData::Frame& tt = ttstack.back();
+
+	    double dtin = t - tt.t0; // elapsed time since start() is called.
+	    double dtex = dtin - tt.tchild;
 
-            for (Stats* st : stats)
+            for (int region : *regions)
             {
-                --(st->depth);
-                ++(st->n);
-                if (st->depth == 0) {
-                    st->dtin += dtin;
+                Stats& st = tdata->stats[region][fid];
+                --(st.depth);
+                ++(st.n);
+                if (st.depth == 0) {
+                    st.dtin += dtin;
                 }
-                st->dtex += dtex;
+                st.dtex += dtex;
             }
-                
+
 	    ttstack.pop_back();
 	    if (!ttstack.empty()) {
-		std::tuple<double,double,std::string*>& parent = ttstack.back();
-		std::get<1>(parent) += dtin;
+		ttstack.back().tchild += dtin;
 	    }
 
 #ifdef AMREX_USE_CUDA
 	    nvtxRangeEnd(nvtx_id);
 #endif
 	} else {
-	    improperly_nested_timers.insert(fname);
-	} 
+            for (int region : *regions) {
+                --(tdata->stats[region][fid].depth);
+            }
+            std::lock_guard<std::mutex> lock(tp_mutex);
+	    improperly_nested_timers.insert(fentry->first);
+	}
 
-        stats.clear();
+        global_depth = -1;
     }
 }
 
 void
 TinyProfiler::Initialize () noexcept
 {
-    regionstack.push_back(mainregion);
+    LocalThreadData().is_main = true;
+    {
+        std::lock_guard<std::mutex> lock(tp_mutex);
+        SetCurrentRegions({RegionId(mainregion)});
+    }
     t_init = amrex::second();
 }
 
@@ -157,7 +292,36 @@ TinyProfiler::Finalize (bool bFlushing) noexcept
     double t_final = amrex::second();
 
     // make a local copy so that any functions call after this will not be recorded in the local copy.
-    auto lstatsmap = statsmap;
+    // The process stats are those of the main thread; all threads go into the thread stats.
+    std::map<std::string,std::map<std::string, Stats> > lstatsmap;
+    std::map<std::string,std::map<std::string, ThreadStats> > lthreadmap;
+    {
+        std::lock_guard<std::mutex> lock(tp_mutex);
+        for (auto const& td : all_thread_data)
+        {
+            for (int r = 0, nr = td->stats.size(); r < nr; ++r)
+            {
+                const std::string& rname = region_names[r];
+                for (int f = 0, nf = td->stats[r].size(); f < nf; ++f)
+                {
+                    const Stats& st = td->stats[r][f];
+                    if (st.n == 0) continue;
+                    const std::string& fname = *func_names[f];
+                    if (td->is_main) {
+                        lstatsmap[rname][fname] = st;
+                    }
+                    ThreadStats& ts = lthreadmap[rname][fname];
+                    ++ts.nthreads;
+                    ts.dtexmin  = std::min(ts.dtexmin, st.dtex);
+                    ts.dtexsum += st.dtex;
+                    ts.dtexmax  = std::max(ts.dtexmax, st.dtex);
+                }
+            }
+        }
+        for (auto const& kv : lthreadmap) {
+            lstatsmap[kv.first];
+        }
+    }
 
     bool properly_nested = improperly_nested_timers.size() == 0;
     ParallelDescriptor::ReduceBoolAnd(properly_nested);
@@ -221,10 +385,12 @@ TinyProfiler::Finalize (bool bFlushing) noexcept
     }
 
     PrintStats(lstatsmap[mainregion], dt_max);
+    PrintThreadStats(lthreadmap[mainregion]);
     for (auto& kv : lstatsmap) {
         if (kv.first != mainregion) {
             amrex::Print() << "\n\nBEGIN REGION " << kv.first << "\n";
             PrintStats(kv.second, dt_max);
+            PrintThreadStats(lthreadmap[kv.first]);
             amrex::Print() << "END REGION " << kv.first << "\n";
         }
     }
@@ -377,19 +543,142 @@ TinyProfiler::PrintStats (std::map<std::string,Stats>& regstats, double dt_max)
     }
 }
 
+void
+TinyProfiler::PrintThreadStats (std::map<std::string,ThreadStats>& regstats)
+{
+    // make sure the set of profiled functions is the same on all processes
+    {
+        Vector<std::string> localStrings, syncedStrings;
+        bool alreadySynced;
+
+        for(auto const& kv : regstats) {
+            localStrings.push_back(kv.first);
+        }
+
+        amrex::SyncStrings(localStrings, syncedStrings, alreadySynced);
+
+        if (! alreadySynced) {  // add the new name
+            for (auto const& s : syncedStrings) {
+                if (regstats.find(s) == regstats.end()) {
+                    regstats.insert(std::make_pair(s, ThreadStats()));
+                }
+            }
+        }
+    }
+
+    if (regstats.empty()) return;
+
+    int ioproc = ParallelDescriptor::IOProcessorNumber();
+    MPI_Comm comm = ParallelDescriptor::Communicator();
+
+    const int nf = regstats.size();
+    std::vector<int> nthreads_max(nf), nthreads_sum(nf);
+    std::vector<double> dtexmin(nf), dtexsum(nf), dtexmax(nf);
+    int i = 0;
+    for (auto const& kv : regstats) {
+        nthreads_max[i] = kv.second.nthreads;
+        nthreads_sum[i] = kv.second.nthreads;
+        dtexmin[i]      = kv.second.dtexmin;
+        dtexsum[i]      = kv.second.dtexsum;
+        dtexmax[i]      = kv.second.dtexmax;
+        ++i;
+    }
+    ParallelReduce::Max(nthreads_max.data(), nf, ioproc, comm);
+    ParallelReduce::Sum(nthreads_sum.data(), nf, ioproc, comm);
+    ParallelReduce::Min(dtexmin.data(), nf, ioproc, comm);
+    ParallelReduce::Sum(dtexsum.data(), nf, ioproc, comm);
+    ParallelReduce::Max(dtexmax.data(), nf, ioproc, comm);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        // only the functions timed on more than one thread of a process
+        std::vector<ProcStats> allthreadstats;
+        int maxfnamelen = 0;
+        int maxnthreads = 0;
+        i = 0;
+        for (auto const& kv : regstats) {
+            if (nthreads_max[i] > 1) {
+                ProcStats pst;
+                pst.fname   = kv.first;
+                pst.nmax    = nthreads_max[i];
+                pst.dtexmin = dtexmin[i];
+                pst.dtexavg = dtexsum[i]/nthreads_sum[i];
+                pst.dtexmax = dtexmax[i];
+                allthreadstats.push_back(pst);
+                maxfnamelen = std::max(maxfnamelen, int(pst.fname.size()));
+                maxnthreads = std::max(maxnthreads, nthreads_max[i]);
+            }
+            ++i;
+        }
+
+        if (allthreadstats.empty()) return;
+
+        amrex::OutStream() << std::setfill(' ') << std::setprecision(4);
+        int wt = 9;
+
+        int wnt = (int) std::log10 ((double) maxnthreads) + 1;
+        wnt = std::max(wnt, int(std::string("NThreads").size()));
+        wt  = std::max(wt,  int(std::string("Excl. Min").size()));
+        int wi = int(std::string("Max/Avg").size());
+
+        const std::string hline(maxfnamelen+wnt+2+(wt+2)*3+wi+2,'-');
+
+        std::sort(allthreadstats.begin(), allthreadstats.end(), ProcStats::compex);
+        amrex::OutStream() << "\nPer-thread exclusive time of functions timed on multiple threads\n";
+        amrex::OutStream() << hline << "\n";
+        amrex::OutStream() << std::left
+                  << std::setw(maxfnamelen) << "Name"
+                  << std::right
+                  << std::setw(wnt+2) << "NThreads"
+                  << std::setw(wt+2) << "Excl. Min"
+                  << std::setw(wt+2) << "Excl. Avg"
+                  << std::setw(wt+2) << "Excl. Max"
+                  << std::setw(wi+2) << "Max/Avg"
+                  << "\n" << hline << "\n";
+        for (auto it = allthreadstats.cbegin(); it != allthreadstats.cend(); ++it)
+        {
+            amrex::OutStream() << std::setprecision(4) << std::left
+                      << std::setw(maxfnamelen) << it->fname
+                      << std::right
+                      << std::setw(wnt+2) << it->nmax
+                      << std::setw(wt+2) << it->dtexmin
+                      << std::setw(wt+2) << it->dtexavg
+                      << std::setw(wt+2) << it->dtexmax
+                      << std::setprecision(2) << std::setw(wi+2) << std::fixed
+                      << ((it->dtexavg > 0.0) ? it->dtexmax/it->dtexavg : 1.0);
+            amrex::OutStream().unsetf(std::ios_base::fixed);
+            amrex::OutStream() << "\n";
+        }
+        amrex::OutStream() << hline << "\n";
+
+        amrex::OutStream() << std::endl;
+    }
+}
+
 void
 TinyProfiler::StartRegion (std::string regname) noexcept
 {
-    if (std::find(regionstack.begin(), regionstack.end(), regname) == regionstack.end()) {
-        regionstack.emplace_back(std::move(regname));
+    std::lock_guard<std::mutex> lock(tp_mutex);
+    const std::vector<int>* cur = current_regions.load(std::memory_order_acquire);
+    if (cur == nullptr) return;
+    const int id = RegionId(regname);
+    if (std::find(cur->begin(), cur->end(), id) == cur->end()) {
+        std::vector<int> regs = *cur;
+        regs.push_back(id);
+        SetCurrentRegions(regs);
     }
 }
 
 void
 TinyProfiler::StopRegion (const std::string& regname) noexcept
 {
-    if (regname == regionstack.back()) {
-        regionstack.pop_back();
+    std::lock_guard<std::mutex> lock(tp_mutex);
+    const std::vector<int>* cur = current_regions.load(std::memory_order_acquire);
+    if (cur == nullptr) return;
+    auto it = region_ids.find(regname);
+    if (it != region_ids.end() && it->second == cur->back()) {
+        std::vector<int> regs(cur->begin(), cur->end()-1);
+        SetCurrentRegions(regs);
     }
 }
 
@@ -419,8 +708,10 @@ void
 TinyProfiler::PrintCallStack (std::ostream& os)
 {
     os << "===== TinyProfilers ======\n";
-    for (auto const& x : ttstack) {
-        os << *(std::get<2>(x)) << "\n";
+    if (local_thread_data) {
+        for (auto const& x : local_thread_data->ttstack) {
+            os << *func_names[x.fid] << "\n";
+        }
     }
 }
 
@@ -6,6 +6,7 @@
 #include <cerrno>
 #include <atomic>
 #include <cstdio>
+#include <cstdlib>
 #include <limits>
 #include <array>
 #include <numeric>
@@ -17,6 +18,8 @@
 #include <AMReX_NFiles.H>
 #include <AMReX_FPC.H>
 #include <AMReX_FabArrayUtility.H>
+#include <AMReX_FabCompress.H>
+#include <AMReX_Machine.H>
 
 namespace amrex {
 
@@ -37,6 +40,14 @@ bool VisMF::usePersistentIFStreams(false);
 bool VisMF::useSynchronousReads(false);
 bool VisMF::useDynamicSetSelection(true);
 bool VisMF::allowSparseWrites(true);
+bool VisMF::asyncWrite(false);
+int  VisMF::headerShards(0);
+bool VisMF::aggregateWrites(false);
+int  VisMF::aggregatorsPerNode(1);
+long VisMF::stripeSize(1048576);
+int  VisMF::compressionCodec(FabCompress::Lossless);
+Real VisMF::compressionErrorBound(0.0);
+Vector<std::future<WriteAsyncStatus> > VisMF::asyncWriteFutures;
 
 long VisMF::ioBufferSize(VisMF::IO_Buffer_Size);
 
@@ -86,6 +97,14 @@ VisMF::Initialize ()
     pp.query("usedynamicsetselection", useDynamicSetSelection);
     pp.query("iobuffersize", ioBufferSize);
     pp.query("allowsparsewrites", allowSparseWrites);
+    pp.query("compressioncodec", compressionCodec);
+    pp.query("compressionerrorbound", compressionErrorBound);
+    pp.query("headershards", headerShards);
+    pp.query("aggregatewrites", aggregateWrites);
+    pp.query("aggregatorspernode", aggregatorsPerNode);
+    aggregatorsPerNode = std::max(1, aggregatorsPerNode);
+    pp.query("stripesize", stripeSize);
+    stripeSize = std::max(1L, std::min(stripeSize, static_cast<long>(std::numeric_limits<int>::max())));
 
     initialized = true;
 }
@@ -93,6 +112,7 @@ VisMF::Initialize ()
 void
 VisMF::Finalize ()
 {
+    VisMF::FinishAsyncWrites();
     initialized = false;
 }
 
@@ -270,6 +290,9 @@ operator<< (std::ostream        &os,
     os.setf(std::ios::floatfield, std::ios::scientific);
     int oldPrec(os.precision(16));
 
+    if(hd.m_nshards > 0) {
+      os << "ShardedHeader " << hd.m_nshards << '\n';
+    }
     os << hd.m_vers     << '\n';
     os << int(hd.m_how) << '\n';
     os << hd.m_ncomp    << '\n';
@@ -281,16 +304,22 @@ operator<< (std::ostream        &os,
 
     hd.m_ba.writeOn(os); os << '\n';
 
-    os << hd.m_fod      << '\n';
+    // ---- with shards, the per-fab data are in the shards and the header
+    // ---- has the FabArray min and max instead
+    const bool fabMinMax(hd.m_vers == VisMF::Header::Version_v1 ||
+                         hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
+                         hd.m_vers == VisMF::Header::CompressedFab_v1);
 
-    if(hd.m_vers == VisMF::Header::Version_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1)
-    {
-      os << hd.m_min      << '\n';
-      os << hd.m_max      << '\n';
+    if(hd.m_nshards == 0) {
+      os << hd.m_fod      << '\n';
+
+      if(fabMinMax) {
+        os << hd.m_min      << '\n';
+        os << hd.m_max      << '\n';
+      }
     }
 
-    if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1) {
+    if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 || (hd.m_nshards > 0 && fabMinMax)) {
       BL_ASSERT(hd.m_famin.size() == hd.m_ncomp);
       BL_ASSERT(hd.m_famin.size() == hd.m_famax.size());
       for(int i(0); i < hd.m_famin.size(); ++i) {
@@ -303,6 +332,19 @@ operator<< (std::ostream        &os,
       os << '\n';
     }
 
+    if(hd.m_vers == VisMF::Header::CompressedFab_v1) {
+      // ---- with shards, the compressed sizes are in the shards too
+      const long nFabs(hd.m_nshards == 0 ? hd.m_csize.size() : 0);
+      BL_ASSERT(hd.m_nshards > 0 || hd.m_csize.size() == hd.m_fod.size());
+      os << hd.m_codec << ' ' << hd.m_errorBound << '\n';
+      os << nFabs << '\n';
+      for(long i(0); i < nFabs; ++i) {
+        os << hd.m_csize[i] << '\n';
+      }
+      // ---- the compressed data are always in the native format
+      os << FPC::NativeRealDescriptor() << '\n';
+    }
+
     if(hd.m_vers == VisMF::Header::NoFabHeader_v1       ||
        hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
        hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
@@ -330,6 +372,16 @@ std::istream&
 operator>> (std::istream  &is,
             VisMF::Header &hd)
 {
+    hd.m_nshards = 0;
+    is >> std::ws;
+    if(is.peek() == 'S') {
+      std::string sharded;
+      is >> sharded >> hd.m_nshards;
+      if(sharded != "ShardedHeader" || hd.m_nshards <= 0) {
+        amrex::Error("Expected ShardedHeader when reading VisMF::Header");
+      }
+    }
+
     is >> hd.m_vers;
     BL_ASSERT(hd.m_vers != VisMF::Header::Undefined_v1);
 
@@ -364,19 +416,28 @@ operator>> (std::istream  &is,
         hd.m_ngrow[i] = 0;
     }
 
-    is >> hd.m_fod;
-    BL_ASSERT(hd.m_ba.size() == hd.m_fod.size());
+    const bool fabMinMax(hd.m_vers == VisMF::Header::Version_v1 ||
+                         hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
+                         hd.m_vers == VisMF::Header::CompressedFab_v1);
 
-    if(hd.m_vers == VisMF::Header::Version_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1)
-    {
-      is >> hd.m_min;
-      is >> hd.m_max;
-      BL_ASSERT(hd.m_ba.size() == hd.m_min.size());
-      BL_ASSERT(hd.m_ba.size() == hd.m_max.size());
+    // ---- with shards, m_fod, m_min and m_max are loaded by ReadHeaderShards
+    if(hd.m_nshards == 0) {
+      is >> hd.m_fod;
+      BL_ASSERT(hd.m_ba.size() == hd.m_fod.size());
+
+      if(fabMinMax) {
+        is >> hd.m_min;
+        is >> hd.m_max;
+        BL_ASSERT(hd.m_ba.size() == hd.m_min.size());
+        BL_ASSERT(hd.m_ba.size() == hd.m_max.size());
+      }
+    } else {
+      hd.m_fod.clear();
+      hd.m_min.clear();
+      hd.m_max.clear();
     }
 
-    if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1) {
+    if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 || (hd.m_nshards > 0 && fabMinMax)) {
       char ch;
       hd.m_famin.resize(hd.m_ncomp);
       hd.m_famax.resize(hd.m_ncomp);
@@ -393,9 +454,21 @@ operator>> (std::istream  &is,
 	}
       }
     }
+    if(hd.m_vers == VisMF::Header::CompressedFab_v1) {
+      long nFabs;
+      is >> hd.m_codec >> hd.m_errorBound;
+      is >> nFabs;
+      BL_ASSERT(nFabs == (hd.m_nshards == 0 ? hd.m_ba.size() : 0));
+      hd.m_csize.resize(nFabs);
+      for(long i(0); i < nFabs; ++i) {
+        is >> hd.m_csize[i];
+      }
+    }
+
     if(hd.m_vers == VisMF::Header::NoFabHeader_v1       ||
        hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
+       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       hd.m_vers == VisMF::Header::CompressedFab_v1)
     {
       is >> hd.m_writtenRD;
     }
@@ -563,6 +636,28 @@ VisMF::readFAB (int idx,
     return VisMF::readFAB(idx, m_fafabname, m_hdr, ncomp);
 }
 
+FArrayBox*
+VisMF::readFAB (std::istream& is,
+                int idx,
+                int ncomp) const
+{
+    return VisMF::readFAB(is, idx, m_hdr, ncomp);
+}
+
+std::string
+VisMF::fabFileName (int idx) const
+{
+    BL_ASSERT(0 <= idx && idx < m_hdr.m_fod.size());
+    return VisMF::DirName(m_fafabname) + m_hdr.m_fod[idx].m_name;
+}
+
+long
+VisMF::fabFileOffset (int idx) const
+{
+    BL_ASSERT(0 <= idx && idx < m_hdr.m_fod.size());
+    return m_hdr.m_fod[idx].m_head;
+}
+
 std::string
 VisMF::BaseName (const std::string& filename)
 {
@@ -639,7 +734,8 @@ VisMF::Write (const FArrayBox&   fab,
 
 VisMF::Header::Header ()
     :
-    m_vers(VisMF::Header::Undefined_v1)
+    m_vers(VisMF::Header::Undefined_v1),
+    m_nshards(0)
 {}
 
 //
@@ -657,10 +753,17 @@ VisMF::Header::Header (const FabArray<FArrayBox>& mf,
     m_ncomp(mf.nComp()),
     m_ngrow(mf.nGrowVect()),
     m_ba(mf.boxArray()),
-    m_fod(m_ba.size())
+    m_fod(m_ba.size()),
+    m_nshards(0)
 {
 //    BL_PROFILE("VisMF::Header");
 
+    if(version == CompressedFab_v1) {
+      m_codec      = compressionCodec;
+      m_errorBound = compressionErrorBound;
+      m_csize.resize(m_ba.size(), 0);
+    }
+
     if(version == NoFabHeader_v1) {
       m_min.clear();
       m_max.clear();
@@ -855,6 +958,32 @@ VisMF::Header::CalculateMinMax (const FabArray<FArrayBox>& mf,
     }
 }
 
+void
+VisMF::Header::CalculateLocalMinMax (const FabArray<FArrayBox>& mf, MPI_Comm comm)
+{
+    m_min.resize(m_ba.size());
+    m_max.resize(m_ba.size());
+    m_famin.assign(m_ncomp,  std::numeric_limits<Real>::max());
+    m_famax.assign(m_ncomp, -std::numeric_limits<Real>::max());
+
+    for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const int idx = mfi.index();
+
+        m_min[idx].resize(m_ncomp);
+        m_max[idx].resize(m_ncomp);
+
+        for(int j(0); j < m_ncomp; ++j) {
+            m_min[idx][j] = mf[mfi].min(m_ba[idx],j);
+            m_max[idx][j] = mf[mfi].max(m_ba[idx],j);
+            m_famin[j] = std::min(m_famin[j], m_min[idx][j]);
+            m_famax[j] = std::max(m_famax[j], m_max[idx][j]);
+        }
+    }
+
+    ParallelAllReduce::Min(m_famin.dataPtr(), m_famin.size(), comm);
+    ParallelAllReduce::Max(m_famax.dataPtr(), m_famax.size(), comm);
+}
+
 long
 VisMF::WriteHeaderDoit (const std::string&mf_name, const VisMF::Header& hdr)
 {
@@ -912,6 +1041,219 @@ VisMF::WriteHeader (const std::string &mf_name, VisMF::Header &hdr,
 }
 
 
+std::string
+VisMF::HeaderShardName (const std::string &mf_name, int ishard)
+{
+    return amrex::Concatenate(mf_name + TheMultiFabHdrFileSuffix + "_", ishard, 5);
+}
+
+long
+VisMF::WriteHeaderShards (const std::string &mf_name, const FabArray<FArrayBox> &mf,
+                          const VisMF::Header &hdr, MPI_Comm comm)
+{
+    BL_PROFILE("VisMF::WriteHeaderShards");
+
+    const int myProc(ParallelDescriptor::MyProc(comm));
+    const int nProcs(ParallelDescriptor::NProcs(comm));
+    const int nBoxes(hdr.m_ba.size());
+    const int nShards(hdr.m_nshards);
+    const bool fabMinMax(hdr.m_vers == VisMF::Header::Version_v1 ||
+                         hdr.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
+                         hdr.m_vers == VisMF::Header::CompressedFab_v1);
+    const bool compressed(hdr.m_vers == VisMF::Header::CompressedFab_v1);
+
+    // ---- shards are written by ranks spread over the communicator
+    auto shardWriter = [nProcs, nShards] (int ishard)
+        { return static_cast<int>((static_cast<long>(ishard) * nProcs) / nShards); };
+
+    // ---- one line per local fab:
+    // ----   index FabOnDisk: name offset [compressed size] [mins, maxes]
+    // ---- the local fabs are in index order, so the lines are in the order
+    // ---- of their shards and of the ranks writing them
+    std::ostringstream oss;
+    oss.setf(std::ios::floatfield, std::ios::scientific);
+    oss.precision(16);
+
+    Vector<int> sendCounts(nProcs, 0);
+    const Vector<int> &localIndices = mf.IndexArray();
+    int ishard(0);
+    long lastPos(0);
+    for(int i(0); i < localIndices.size(); ++i) {
+      const int idx(localIndices[i]);
+      while(HeaderShardBegin(nBoxes, nShards, ishard+1) <= idx) {
+        ++ishard;
+      }
+      oss << idx << ' ' << hdr.m_fod[idx];
+      if(compressed) {
+        oss << ' ' << hdr.m_csize[idx];
+      }
+      if(fabMinMax) {
+        oss << ' ';
+        for(int n(0); n < hdr.m_ncomp; ++n) {
+          oss << hdr.m_min[idx][n] << ',';
+        }
+        oss << ' ';
+        for(int n(0); n < hdr.m_ncomp; ++n) {
+          oss << hdr.m_max[idx][n] << ',';
+        }
+      }
+      oss << '\n';
+      const long pos(static_cast<std::streamoff>(oss.tellp()));
+      sendCounts[shardWriter(ishard)] += static_cast<int>(pos - lastPos);
+      lastPos = pos;
+    }
+    std::string sendData(oss.str());
+
+#ifdef BL_USE_MPI
+    Vector<int> recvCounts(nProcs, 0);
+    BL_MPI_REQUIRE( MPI_Alltoall(sendCounts.dataPtr(), 1, MPI_INT,
+                                 recvCounts.dataPtr(), 1, MPI_INT, comm) );
+
+    Vector<int> sendOffset(nProcs, 0), recvOffset(nProcs, 0);
+    for(int i(1); i < nProcs; ++i) {
+      sendOffset[i] = sendOffset[i-1] + sendCounts[i-1];
+      recvOffset[i] = recvOffset[i-1] + recvCounts[i-1];
+    }
+    std::string recvData(recvOffset[nProcs-1] + recvCounts[nProcs-1], '\0');
+
+    BL_COMM_PROFILE(BLProfiler::Alltoallv, recvData.size(), myProc, BLProfiler::BeforeCall());
+
+    BL_MPI_REQUIRE( MPI_Alltoallv(&sendData[0], sendCounts.dataPtr(), sendOffset.dataPtr(), MPI_CHAR,
+                                  &recvData[0], recvCounts.dataPtr(), recvOffset.dataPtr(), MPI_CHAR,
+                                  comm) );
+
+    BL_COMM_PROFILE(BLProfiler::Alltoallv, recvData.size(), myProc, BLProfiler::AfterCall());
+#else
+    std::string recvData(std::move(sendData));
+#endif
+
+    long bytesWritten(0);
+
+    for(int is(0); is < nShards; ++is) {
+      if(shardWriter(is) != myProc) {
+        continue;
+      }
+      const int begin(HeaderShardBegin(nBoxes, nShards, is));
+      const int end(HeaderShardBegin(nBoxes, nShards, is+1));
+
+      // ---- put the lines in index order
+      Vector<std::pair<const char *, int> > lines(end - begin, std::make_pair(nullptr, 0));
+      for(std::size_t lpos(0); lpos < recvData.size(); ) {
+        std::size_t lend(recvData.find('\n', lpos));
+        const int idx(std::atoi(recvData.c_str() + lpos));
+        if(idx >= begin && idx < end) {  // ---- this rank may write several shards
+          lines[idx - begin] = std::make_pair(recvData.c_str() + lpos, static_cast<int>(lend + 1 - lpos));
+        }
+        lpos = lend + 1;
+      }
+
+      std::string shardName(HeaderShardName(mf_name, is));
+      VisMF::IO_Buffer io_buffer(ioBufferSize);
+      std::ofstream shardFile;
+      shardFile.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
+      shardFile.open(shardName.c_str(), std::ios::out | std::ios::trunc);
+      if( ! shardFile.good()) {
+        amrex::FileOpenFailed(shardName);
+      }
+
+      shardFile << begin << ' ' << end - begin << '\n';
+      for(int i(0); i < lines.size(); ++i) {
+        if(lines[i].first == nullptr) {
+          amrex::Abort("VisMF::WriteHeaderShards:  missing fab in shard");
+        }
+        shardFile.write(lines[i].first, lines[i].second);
+      }
+
+      bytesWritten += VisMF::FileOffset(shardFile);
+      shardFile.close();
+    }
+
+    return bytesWritten;
+}
+
+void
+VisMF::ReadHeaderShards (const std::string &mf_name, VisMF::Header &hdr,
+                         const Vector<int> &indices)
+{
+    BL_PROFILE("VisMF::ReadHeaderShards");
+
+    const int nBoxes(hdr.m_ba.size());
+    const int nShards(hdr.m_nshards);
+    const bool fabMinMax(hdr.m_vers == VisMF::Header::Version_v1 ||
+                         hdr.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
+                         hdr.m_vers == VisMF::Header::CompressedFab_v1);
+    const bool compressed(hdr.m_vers == VisMF::Header::CompressedFab_v1);
+
+    hdr.m_fod.resize(nBoxes);
+    if(compressed) {
+      hdr.m_csize.resize(nBoxes, 0);
+    }
+    if(fabMinMax) {
+      hdr.m_min.resize(nBoxes);
+      hdr.m_max.resize(nBoxes);
+    }
+
+    VisMF::IO_Buffer io_buffer(ioBufferSize);
+    int ishard(0);
+
+    for(int i(0); i < indices.size(); ) {
+      while(HeaderShardBegin(nBoxes, nShards, ishard+1) <= indices[i]) {
+        ++ishard;
+      }
+
+      std::string shardName(HeaderShardName(mf_name, ishard));
+      std::ifstream shardFile;
+      shardFile.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
+      shardFile.open(shardName.c_str(), std::ios::in);
+      if( ! shardFile.good()) {
+        amrex::FileOpenFailed(shardName);
+      }
+
+      int begin, nLines;
+      shardFile >> begin >> nLines;
+      shardFile.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+      if(begin != HeaderShardBegin(nBoxes, nShards, ishard)) {
+        amrex::Error("VisMF::ReadHeaderShards:  bad shard " + shardName);
+      }
+
+      // ---- parse only the lines of the fabs asked for
+      int line(begin);
+      for( ; i < indices.size() && indices[i] < begin + nLines; ++i) {
+        for( ; line < indices[i]; ++line) {
+          shardFile.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+        int idx;
+        shardFile >> idx >> hdr.m_fod[indices[i]];
+        if(idx != indices[i]) {
+          amrex::Error("VisMF::ReadHeaderShards:  bad line in shard " + shardName);
+        }
+        if(compressed) {
+          shardFile >> hdr.m_csize[idx];
+        }
+        if(fabMinMax) {
+          char ch;
+          double v;
+          hdr.m_min[idx].resize(hdr.m_ncomp);
+          hdr.m_max[idx].resize(hdr.m_ncomp);
+          for(int n(0); n < hdr.m_ncomp; ++n) {
+            shardFile >> v >> ch;
+            hdr.m_min[idx][n] = static_cast<Real>(v);
+          }
+          for(int n(0); n < hdr.m_ncomp; ++n) {
+            shardFile >> v >> ch;
+            hdr.m_max[idx][n] = static_cast<Real>(v);
+          }
+        }
+        shardFile.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        ++line;
+      }
+
+      if( ! shardFile.good()) {
+        amrex::Error("VisMF::ReadHeaderShards:  read of " + shardName + " failed");
+      }
+    }
+}
+
 long
 VisMF::Write (const FabArray<FArrayBox>&    mf,
               const std::string& mf_name,
@@ -952,6 +1294,33 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
         }
     }
 
+    if(asyncWrite && how == NFiles && currentVersion == VisMF::Header::Version_v1) {
+      // ---- the data is staged before WriteAsync returns
+      // ---- return the bytes the background write will put on disk
+      long bytesWritten(0);
+      const FABio &fio = FArrayBox::getFABio();
+      for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        std::stringstream hss;
+        fio.write_header(hss, mf[mfi], mf.nComp());
+        bytesWritten += static_cast<std::streamoff>(hss.tellp());
+        bytesWritten += mf[mfi].size() * whichRD->numBytes();
+      }
+      delete whichRD;
+      asyncWriteFutures.push_back(VisMF::WriteAsync(mf, mf_name));
+      return bytesWritten;
+    }
+
+    if(currentVersion == VisMF::Header::CompressedFab_v1) {
+      delete whichRD;
+      return VisMF::WriteCompressed(mf, mf_name, how);
+    }
+
+    if(aggregateWrites && how == NFiles) {
+      long bytesWritten(VisMF::WriteAggregated(mf, mf_name, how, *whichRD));
+      delete whichRD;
+      return bytesWritten;
+    }
+
     // ---- check if mf has sparse data
     bool useSparseFPP(false);
     const Vector<int> &pmap = mf.DistributionMap().ProcessorMap();
@@ -979,6 +1348,9 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
 
     bool oldHeader(currentVersion == VisMF::Header::Version_v1);
 
+    // ---- with header shards, each rank keeps the offsets of its own fabs
+    bool shardHeader(headerShards > 0);
+
       if(useSparseFPP) {
         nfi.SetSparseFPP(procsWithDataVector);
       } else if(useDynamicSetSelection) {
@@ -1010,6 +1382,12 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
 	    canCombineFABs = true;
 	  }
 
+	  long fileOffset(0);
+	  const std::string fileName(VisMF::BaseName(nfi.FileName()));
+	  if(shardHeader) {
+	    fileOffset = VisMF::FileOffset(nfi.Stream());
+	  }
+
 	  if(canCombineFABs) {
             long writePosition(0);
             for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
@@ -1032,6 +1410,9 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
 	      } else {    // ---- copy from the fab
 	        memcpy(afPtr + hLength, fab.dataPtr(), writeDataSize);
 	      }
+	      if(shardHeader) {
+	        hdr.m_fod[mfi.index()] = FabOnDisk(fileName, fileOffset + writePosition);
+	      }
               writePosition += hLength + writeDataSize;
             }
             nfi.Stream().write(allFabData, bytesWritten);
@@ -1052,6 +1433,10 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
                 nfi.Stream().write(tstr.c_str(), hLength);    // ---- the fab header
                 nfi.Stream().flush();
 	      }
+	      if(shardHeader) {
+	        hdr.m_fod[mfi.index()] = FabOnDisk(fileName, fileOffset);
+	        fileOffset += hLength + writeDataSize;
+	      }
 	      if(doConvert) {
 	        char *cDataPtr = new char[writeDataSize];
 	        RealDescriptor::convertFromNativeFormat(static_cast<void *> (cDataPtr),
@@ -1073,14 +1458,28 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
       coordinatorProc = nfi.CoordinatorProc();
     }
 
-    if(currentVersion == VisMF::Header::Version_v1 ||
-       currentVersion == VisMF::Header::NoFabHeaderMinMax_v1)
-    {
-      hdr.CalculateMinMax(mf, coordinatorProc);
-    }
+    if(shardHeader) {
+      // ---- no gather to the coordinator, only FabArray mins and maxes
+      const int nShards(std::min(headerShards, ParallelDescriptor::NProcs()));
+      hdr.m_nshards = std::max(1, std::min(nShards, static_cast<int>(hdr.m_ba.size())));
+
+      if(currentVersion == VisMF::Header::Version_v1 ||
+         currentVersion == VisMF::Header::NoFabHeaderMinMax_v1)
+      {
+        hdr.CalculateLocalMinMax(mf);
+      }
+
+      bytesWritten += VisMF::WriteHeaderShards(mf_name, mf, hdr);
+    } else {
+      if(currentVersion == VisMF::Header::Version_v1 ||
+         currentVersion == VisMF::Header::NoFabHeaderMinMax_v1)
+      {
+        hdr.CalculateMinMax(mf, coordinatorProc);
+      }
 
-    VisMF::FindOffsets(mf, filePrefix, hdr, groupSets, currentVersion, nfi,
-                       ParallelDescriptor::Communicator());
+      VisMF::FindOffsets(mf, filePrefix, hdr, groupSets, currentVersion, nfi,
+                         ParallelDescriptor::Communicator());
+    }
 
     bytesWritten += VisMF::WriteHeader(mf_name, hdr, coordinatorProc);
 
@@ -1090,6 +1489,415 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
 }
 
 
+long
+VisMF::WriteCompressed (const FabArray<FArrayBox> &mf,
+                        const std::string &mf_name,
+                        VisMF::How how)
+{
+    BL_PROFILE("VisMF::WriteCompressed()");
+
+    const int myProc(ParallelDescriptor::MyProc());
+    const int nProcs(ParallelDescriptor::NProcs());
+    const int coordinatorProc(ParallelDescriptor::IOProcessorNumber());
+    bool calcMinMax(false);
+    VisMF::Header hdr(mf, how, VisMF::Header::CompressedFab_v1, calcMinMax);
+
+    // ---- compress before waiting for a turn to write
+    const int nLocal(mf.local_size());
+    Vector<Vector<char> > cData(nLocal);
+    for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+      const FArrayBox &fab = mf[mfi];
+      FabCompress::Compress(fab.dataPtr(), fab.box().numPts() * mf.nComp(),
+                            hdr.m_codec, hdr.m_errorBound, cData[mfi.LocalIndex()]);
+    }
+
+    std::string filePrefix(mf_name + FabFileSuffix);
+    long bytesWritten(0);
+
+    // ---- [fab index, file number, offset, compressed size] for each local fab
+    const int nInfo(4);
+    Vector<long> localInfo(std::max(1, nInfo * nLocal));
+
+    // ---- no dynamic set selection, the file positions are recorded
+    // ---- by the writers themselves
+    NFilesIter nfi(nOutFiles, filePrefix, groupSets, setBuf);
+    for( ; nfi.ReadyToWrite(); ++nfi) {
+      // ---- streams opened for appending do not start at the end
+      nfi.Stream().seekp(0, std::ios::end);
+      for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const int li(mfi.LocalIndex());
+        const long nBytes(cData[li].size());
+        localInfo[nInfo * li    ] = mfi.index();
+        localInfo[nInfo * li + 1] = nfi.FileNumber();
+        localInfo[nInfo * li + 2] = static_cast<std::streamoff>(nfi.SeekPos());
+        localInfo[nInfo * li + 3] = nBytes;
+        nfi.Stream().write(cData[li].dataPtr(), nBytes);
+        bytesWritten += nBytes;
+      }
+      nfi.Stream().flush();
+    }
+
+    if(headerShards > 0) {
+      // ---- each rank puts the locations of its own fabs in the shards
+      const int nShards(std::min(headerShards, nProcs));
+      hdr.m_nshards = std::max(1, std::min(nShards, static_cast<int>(hdr.m_ba.size())));
+      for(int li(0); li < nLocal; ++li) {
+        const long *info = localInfo.dataPtr() + nInfo * li;
+        const int idx(info[0]);
+        hdr.m_fod[idx].m_name = VisMF::BaseName(NFilesIter::FileName(info[1], filePrefix));
+        hdr.m_fod[idx].m_head = info[2];
+        hdr.m_csize[idx]      = info[3];
+      }
+      hdr.CalculateLocalMinMax(mf);
+      bytesWritten += VisMF::WriteHeaderShards(mf_name, mf, hdr);
+      bytesWritten += VisMF::WriteHeader(mf_name, hdr, coordinatorProc);
+      return bytesWritten;
+    }
+
+    Vector<long> allInfo;
+#ifdef BL_USE_MPI
+    std::vector<int> recvCounts(nProcs, 0), recvDisps(nProcs, 0);
+    const Vector<int> &pmap = mf.DistributionMap().ProcessorMap();
+    for(int i(0); i < pmap.size(); ++i) {
+      recvCounts[pmap[i]] += nInfo;
+    }
+    for(int i(1); i < nProcs; ++i) {
+      recvDisps[i] = recvDisps[i-1] + recvCounts[i-1];
+    }
+    if(myProc == coordinatorProc) {
+      allInfo.resize(std::max(1, nInfo * mf.size()));
+    }
+    ParallelDescriptor::Gatherv(localInfo.dataPtr(), nInfo * nLocal,
+                                allInfo.dataPtr(), recvCounts, recvDisps,
+                                coordinatorProc);
+#else
+    allInfo = localInfo;
+#endif
+
+    if(myProc == coordinatorProc) {
+      for(int i(0); i < mf.size(); ++i) {
+        const long *info = allInfo.dataPtr() + nInfo * i;
+        const int idx(info[0]);
+        hdr.m_fod[idx].m_name = VisMF::BaseName(NFilesIter::FileName(info[1], filePrefix));
+        hdr.m_fod[idx].m_head = info[2];
+        hdr.m_csize[idx]      = info[3];
+      }
+    }
+
+    hdr.CalculateMinMax(mf, coordinatorProc);
+
+    bytesWritten += VisMF::WriteHeader(mf_name, hdr, coordinatorProc);
+
+    return bytesWritten;
+}
+
+
+void
+VisMF::ReadCompressedFab (std::istream &is, const VisMF::Header &hdr,
+                          int idx, FArrayBox &fab, int whichComp)
+{
+    const long nPts(fab.box().numPts());
+    const long nBytes(hdr.m_csize[idx]);
+    Vector<char> cData(nBytes);
+    is.read(cData.dataPtr(), nBytes);
+    if( ! is.good()) {
+      amrex::Error("VisMF::ReadCompressedFab:  read failed");
+    }
+    if(FabCompress::NumValues(cData.dataPtr()) != nPts * hdr.m_ncomp) {
+      amrex::Error("VisMF::ReadCompressedFab:  FAB size does not match the header");
+    }
+
+    if(whichComp == -1) {    // ---- read all components
+      BL_ASSERT(fab.nComp() == hdr.m_ncomp);
+      FabCompress::Decompress(cData.dataPtr(), nBytes, hdr.m_writtenRD,
+                              fab.dataPtr(), nPts * hdr.m_ncomp);
+    } else {
+      Vector<Real> allComps(nPts * hdr.m_ncomp);
+      FabCompress::Decompress(cData.dataPtr(), nBytes, hdr.m_writtenRD,
+                              allComps.dataPtr(), allComps.size());
+      std::memcpy(fab.dataPtr(), allComps.dataPtr() + nPts * whichComp, nPts * sizeof(Real));
+    }
+}
+
+
+int
+VisMF::AggregatorGroups (Vector<int> &groupOfProc, Vector<int> &aggregatorOfGroup)
+{
+    const int nProcs(ParallelDescriptor::NProcs());
+    const Vector<int> &nodeIds = machine::node_ids();
+    BL_ASSERT(nodeIds.size() == nProcs);
+
+    // ---- the ranks on each node, with the nodes in the order of their first rank
+    std::map<int, int> nodeIndex;
+    Vector<Vector<int> > nodeProcs;
+    for(int ip(0); ip < nProcs; ++ip) {
+      auto it = nodeIndex.find(nodeIds[ip]);
+      if(it == nodeIndex.end()) {
+        it = nodeIndex.emplace(nodeIds[ip], nodeProcs.size()).first;
+        nodeProcs.emplace_back();
+      }
+      nodeProcs[it->second].push_back(ip);
+    }
+
+    // ---- split each node into contiguous groups led by their first rank
+    groupOfProc.resize(nProcs);
+    aggregatorOfGroup.clear();
+    for(const auto &procs : nodeProcs) {
+      const int nRanks(procs.size());
+      const int nAggregators(std::min(aggregatorsPerNode, nRanks));
+      const int firstGroup(aggregatorOfGroup.size());
+      for(int i(0); i < nRanks; ++i) {
+        const int group(firstGroup + static_cast<int>((static_cast<long>(i) * nAggregators) / nRanks));
+        if(group == aggregatorOfGroup.size()) {
+          aggregatorOfGroup.push_back(procs[i]);
+        }
+        groupOfProc[procs[i]] = group;
+      }
+    }
+
+    return aggregatorOfGroup.size();
+}
+
+
+long
+VisMF::WriteAggregated (const FabArray<FArrayBox> &mf,
+                        const std::string &mf_name,
+                        VisMF::How how,
+                        const RealDescriptor &whichRD)
+{
+    BL_PROFILE("VisMF::WriteAggregated()");
+
+    MPI_Comm comm(ParallelDescriptor::Communicator());
+    const int myProc(ParallelDescriptor::MyProc(comm));
+    const int nProcs(ParallelDescriptor::NProcs(comm));
+    const int coordinatorProc(ParallelDescriptor::IOProcessorNumber());
+    const bool doConvert(whichRD != FPC::NativeRealDescriptor());
+    const bool oldHeader(currentVersion == VisMF::Header::Version_v1);
+    const bool shardHeader(headerShards > 0);
+    bool calcMinMax(false);
+    VisMF::Header hdr(mf, how, currentVersion, calcMinMax);
+
+    // ---- pack the local fabs as they will be in the file
+    const FABio &fio = FArrayBox::getFABio();
+    const int whichRDBytes(whichRD.numBytes());
+    const int nLocal(mf.local_size());
+    Vector<std::string> fabHeaders(oldHeader ? nLocal : 0);
+    Vector<long> localOffset(nLocal + 1, 0);
+    for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+      const int li(mfi.LocalIndex());
+      long nBytes(mf[mfi].box().numPts() * mf.nComp() * whichRDBytes);
+      if(oldHeader) {
+        std::stringstream hss;
+        fio.write_header(hss, mf[mfi], mf.nComp());
+        fabHeaders[li] = hss.str();
+        nBytes += fabHeaders[li].size();
+      }
+      localOffset[li + 1] = localOffset[li] + nBytes;
+    }
+    const long localBytes(localOffset[nLocal]);
+
+    Vector<char> localData(localBytes);
+    for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+      const int li(mfi.LocalIndex());
+      const FArrayBox &fab = mf[mfi];
+      const long nItems(fab.box().numPts() * mf.nComp());
+      char *dataPtr = localData.dataPtr() + localOffset[li];
+      if(oldHeader) {
+        std::memcpy(dataPtr, fabHeaders[li].data(), fabHeaders[li].size());
+        dataPtr += fabHeaders[li].size();
+      }
+      if(doConvert) {
+        RealDescriptor::convertFromNativeFormat(static_cast<void *> (dataPtr), nItems,
+                                                fab.dataPtr(), whichRD);
+      } else {
+        std::memcpy(dataPtr, fab.dataPtr(), nItems * whichRDBytes);
+      }
+    }
+
+    // ---- each group writes one file with its ranks' data in rank order
+    Vector<int> groupOfProc, aggregatorOfGroup;
+    VisMF::AggregatorGroups(groupOfProc, aggregatorOfGroup);
+    const int myGroup(groupOfProc[myProc]);
+    const int aggregatorProc(aggregatorOfGroup[myGroup]);
+
+    Vector<long> procBytes(nProcs, 0);
+    ParallelAllGather::AllGather(localBytes, procBytes.dataPtr(), comm);
+
+    Vector<int> members;
+    Vector<long> memberOffset;
+    long groupBytes(0), myOffset(0);
+    for(int ip(0); ip < nProcs; ++ip) {
+      if(groupOfProc[ip] == myGroup) {
+        if(ip == myProc) {
+          myOffset = groupBytes;
+        }
+        members.push_back(ip);
+        memberOffset.push_back(groupBytes);
+        groupBytes += procBytes[ip];
+      }
+    }
+
+    const std::string filePrefix(mf_name + FabFileSuffix);
+    const std::string fileName(NFilesIter::FileName(myGroup, filePrefix));
+    for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+      hdr.m_fod[mfi.index()] = FabOnDisk(VisMF::BaseName(fileName),
+                                         myOffset + localOffset[mfi.LocalIndex()]);
+    }
+
+    // ---- phase one:  send the data to the aggregator in pieces that do not
+    // ---- cross stripes, so each stripe can be received and written by itself
+    const long stripe(stripeSize);
+    const int tag(ParallelDescriptor::SeqNum());
+    long bytesWritten(0);
+
+#ifdef BL_USE_MPI
+    Vector<MPI_Request> sendReqs;
+    if(myProc != aggregatorProc) {
+      for(long pos(0); pos < localBytes; ) {
+        const long filePos(myOffset + pos);
+        const int nBytes(std::min(localBytes - pos, stripe - filePos % stripe));
+        sendReqs.push_back(MPI_REQUEST_NULL);
+        BL_MPI_REQUIRE( MPI_Isend(localData.dataPtr() + pos, nBytes, MPI_CHAR,
+                                  aggregatorProc, tag, comm, &sendReqs.back()) );
+        pos += nBytes;
+      }
+    }
+#endif
+
+    // ---- phase two:  the aggregator receives the next stripe while it writes this one
+    if(myProc == aggregatorProc && groupBytes > 0) {
+      const long nStripes((groupBytes + stripe - 1) / stripe);
+      std::array<Vector<char>, 2> stripeBuffer;
+      stripeBuffer[0].resize(std::min(stripe, groupBytes));
+      stripeBuffer[1].resize(nStripes > 1 ? stripe : 0);
+#ifdef BL_USE_MPI
+      std::array<Vector<MPI_Request>, 2> recvReqs;
+#endif
+
+      auto startStripe = [&] (long is, int ib)
+      {
+        const long sBegin(is * stripe);
+        const long sEnd(std::min(groupBytes, sBegin + stripe));
+        for(int im(0); im < members.size(); ++im) {
+          const long mBegin(std::max(sBegin, memberOffset[im]));
+          const long mEnd(std::min(sEnd, memberOffset[im] + procBytes[members[im]]));
+          if(mBegin >= mEnd) {
+            continue;
+          }
+          char *dst = stripeBuffer[ib].dataPtr() + (mBegin - sBegin);
+          if(members[im] == myProc) {
+            std::memcpy(dst, localData.dataPtr() + (mBegin - myOffset), mEnd - mBegin);
+          } else {
+#ifdef BL_USE_MPI
+            recvReqs[ib].push_back(MPI_REQUEST_NULL);
+            BL_MPI_REQUIRE( MPI_Irecv(dst, static_cast<int>(mEnd - mBegin), MPI_CHAR,
+                                      members[im], tag, comm, &recvReqs[ib].back()) );
+#endif
+          }
+        }
+      };
+
+      // ---- unbuffered, the stripes go straight to the file
+      std::ofstream ofs;
+      ofs.rdbuf()->pubsetbuf(nullptr, 0);
+      ofs.open(fileName.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+      if( ! ofs.good()) {
+        amrex::FileOpenFailed(fileName);
+      }
+
+      startStripe(0, 0);
+      for(long is(0); is < nStripes; ++is) {
+        const int ib(is % 2);
+        if(is + 1 < nStripes) {
+          startStripe(is + 1, 1 - ib);
+        }
+#ifdef BL_USE_MPI
+        if( ! recvReqs[ib].empty()) {
+          BL_MPI_REQUIRE( MPI_Waitall(recvReqs[ib].size(), recvReqs[ib].dataPtr(),
+                                      MPI_STATUSES_IGNORE) );
+          recvReqs[ib].clear();
+        }
+#endif
+        const long nBytes(std::min(stripe, groupBytes - is * stripe));
+        ofs.write(stripeBuffer[ib].dataPtr(), nBytes);
+        bytesWritten += nBytes;
+      }
+
+      ofs.close();
+      if( ! ofs.good()) {
+        amrex::Error("VisMF::WriteAggregated:  write of " + fileName + " failed");
+      }
+    }
+
+#ifdef BL_USE_MPI
+    if( ! sendReqs.empty()) {
+      BL_MPI_REQUIRE( MPI_Waitall(sendReqs.size(), sendReqs.dataPtr(), MPI_STATUSES_IGNORE) );
+    }
+#endif
+
+    if(shardHeader) {
+      const int nShards(std::min(headerShards, nProcs));
+      hdr.m_nshards = std::max(1, std::min(nShards, static_cast<int>(hdr.m_ba.size())));
+
+      if(currentVersion == VisMF::Header::Version_v1 ||
+         currentVersion == VisMF::Header::NoFabHeaderMinMax_v1)
+      {
+        hdr.CalculateLocalMinMax(mf);
+      }
+
+      bytesWritten += VisMF::WriteHeaderShards(mf_name, mf, hdr);
+    } else {
+      if(currentVersion == VisMF::Header::Version_v1 ||
+         currentVersion == VisMF::Header::NoFabHeaderMinMax_v1)
+      {
+        hdr.CalculateMinMax(mf, coordinatorProc);
+      }
+
+      // ---- [fab index, group, offset] for each local fab
+      const int nInfo(3);
+      Vector<long> localInfo(std::max(1, nInfo * nLocal));
+      for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const int li(mfi.LocalIndex());
+        localInfo[nInfo * li    ] = mfi.index();
+        localInfo[nInfo * li + 1] = myGroup;
+        localInfo[nInfo * li + 2] = hdr.m_fod[mfi.index()].m_head;
+      }
+
+      Vector<long> allInfo;
+#ifdef BL_USE_MPI
+      std::vector<int> recvCounts(nProcs, 0), recvDisps(nProcs, 0);
+      const Vector<int> &pmap = mf.DistributionMap().ProcessorMap();
+      for(int i(0); i < pmap.size(); ++i) {
+        recvCounts[pmap[i]] += nInfo;
+      }
+      for(int i(1); i < nProcs; ++i) {
+        recvDisps[i] = recvDisps[i-1] + recvCounts[i-1];
+      }
+      if(myProc == coordinatorProc) {
+        allInfo.resize(std::max(1, nInfo * mf.size()));
+      }
+      ParallelDescriptor::Gatherv(localInfo.dataPtr(), nInfo * nLocal,
+                                  allInfo.dataPtr(), recvCounts, recvDisps,
+                                  coordinatorProc);
+#else
+      allInfo = localInfo;
+#endif
+
+      if(myProc == coordinatorProc) {
+        for(int i(0); i < mf.size(); ++i) {
+          const long *info = allInfo.dataPtr() + nInfo * i;
+          const int idx(info[0]);
+          hdr.m_fod[idx].m_name = VisMF::BaseName(NFilesIter::FileName(info[1], filePrefix));
+          hdr.m_fod[idx].m_head = info[2];
+        }
+      }
+    }
+
+    bytesWritten += VisMF::WriteHeader(mf_name, hdr, coordinatorProc);
+
+    return bytesWritten;
+}
+
 long
 VisMF::WriteOnlyHeader (const FabArray<FArrayBox> & mf,
                         const std::string         & mf_name,
@@ -1306,17 +2114,32 @@ VisMF::RemoveFiles(const std::string &mf_name, bool verbose)
 	            << strerror(errno) << std::endl;
         }
       }
-      for(int ip(0); ip < nOutFiles; ++ip) {
-        std::string fileName(NFilesIter::FileName(nOutFiles, mf_name + FabFileSuffix, ip, true));
+      for(int is(0); ; ++is) {
+        std::string shardName(HeaderShardName(mf_name, is));
+        if(std::remove(shardName.c_str()) != 0) {
+          break;
+        }
+        if(verbose) {
+          amrex::Print() << "---- removed:  " << shardName << std::endl;
+        }
+      }
+      // ---- aggregated writes use one file per aggregator group, which
+      // ---- can be more or fewer than nOutFiles, so keep going past
+      // ---- nOutFiles until a file is missing
+      for(int ip(0); ; ++ip) {
+        std::string fileName(NFilesIter::FileName(ip, mf_name + FabFileSuffix));
         if(verbose) {
           amrex::Print() << "---- removing:  " << fileName << std::endl;
 	}
         int rv(std::remove(fileName.c_str()));
-        if(verbose) {
-          if(rv != 0) {
+        if(rv != 0) {
+          if(verbose) {
             amrex::Print() << "---- error removing:  " << fileName << "  errno = "
 	              << strerror(errno) << std::endl;
           }
+          if(ip >= nOutFiles) {
+            break;
+          }
 	}
       }
     }
@@ -1338,6 +2161,12 @@ VisMF::VisMF (const std::string &fafab_name)
 
     infs >> m_hdr;
 
+    if(m_hdr.m_nshards > 0) {
+      Vector<int> allIndices(m_hdr.m_ba.size());
+      std::iota(allIndices.begin(), allIndices.end(), 0);
+      VisMF::ReadHeaderShards(m_fafabname, m_hdr, allIndices);
+    }
+
     m_pa.resize(m_hdr.m_ncomp);
 
     for(int n(0); n < m_pa.size(); ++n) {
@@ -1362,6 +2191,26 @@ VisMF::readFAB (int                  idx,
 		int                  whichComp)
 {
 //    BL_PROFILE("VisMF::readFAB_idx");
+    std::string FullName(VisMF::DirName(mf_name));
+    FullName += hdr.m_fod[idx].m_name;
+
+    std::ifstream *infs = VisMF::OpenStream(FullName);
+    infs->seekg(hdr.m_fod[idx].m_head, std::ios::beg);
+
+    FArrayBox *fab = VisMF::readFAB(*infs, idx, hdr, whichComp);
+
+    VisMF::CloseStream(FullName);
+
+    return fab;
+}
+
+
+FArrayBox*
+VisMF::readFAB (std::istream        &is,
+                int                  idx,
+                const VisMF::Header &hdr,
+		int                  whichComp)
+{
     Box fab_box(hdr.m_ba[idx]);
     if(hdr.m_ngrow.max() > 0) {
         fab_box.grow(hdr.m_ngrow);
@@ -1369,43 +2218,37 @@ VisMF::readFAB (int                  idx,
 
     FArrayBox *fab = new FArrayBox(fab_box, whichComp == -1 ? hdr.m_ncomp : 1);
 
-    std::string FullName(VisMF::DirName(mf_name));
-    FullName += hdr.m_fod[idx].m_name;
-
-    std::ifstream *infs = VisMF::OpenStream(FullName);
-    infs->seekg(hdr.m_fod[idx].m_head, std::ios::beg);
-
-    if(hdr.m_vers == Header::Version_v1) {
+    if(hdr.m_vers == Header::CompressedFab_v1) {
+      VisMF::ReadCompressedFab(is, hdr, idx, *fab, whichComp);
+    } else if(hdr.m_vers == Header::Version_v1) {
       if(whichComp == -1) {    // ---- read all components
-        fab->readFrom(*infs);
+        fab->readFrom(is);
       } else {
-        fab->readFrom(*infs, whichComp);
+        fab->readFrom(is, whichComp);
       }
     } else {
       if(whichComp == -1) {    // ---- read all components
 	if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
-          infs->read((char *) fab->dataPtr(), fab->nBytes());
+          is.read((char *) fab->dataPtr(), fab->nBytes());
 	} else {
           long readDataItems(fab->box().numPts() * fab->nComp());
           RealDescriptor::convertToNativeFormat(fab->dataPtr(), readDataItems,
-	                                        *infs, hdr.m_writtenRD);
+	                                        is, hdr.m_writtenRD);
 	}
 
       } else {
         long bytesPerComp(fab->box().numPts() * hdr.m_writtenRD.numBytes());
-        infs->seekg(bytesPerComp * whichComp, std::ios::cur);
+        is.seekg(bytesPerComp * whichComp, std::ios::cur);
 	if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
-          infs->read((char *) fab->dataPtr(), bytesPerComp);
+          is.read((char *) fab->dataPtr(), bytesPerComp);
 	} else {
           long readDataItems(fab->box().numPts());  // ---- one component only
           RealDescriptor::convertToNativeFormat(fab->dataPtr(), readDataItems,
-	                                        *infs, hdr.m_writtenRD);
+	                                        is, hdr.m_writtenRD);
 	}
       }
     }
 
-    VisMF::CloseStream(FullName);
-
     return fab;
 }
 
@@ -1425,7 +2268,9 @@ VisMF::readFAB (FabArray<FArrayBox> &mf,
     std::ifstream *infs = VisMF::OpenStream(FullName);
     infs->seekg(hdr.m_fod[idx].m_head, std::ios::beg);
 
-    if(NoFabHeader(hdr)) {
+    if(hdr.m_vers == Header::CompressedFab_v1) {
+      VisMF::ReadCompressedFab(*infs, hdr, idx, fab);
+    } else if(NoFabHeader(hdr)) {
       if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
         infs->read((char *) fab.dataPtr(), fab.nBytes());
       } else {
@@ -1500,6 +2345,14 @@ VisMF::Read (FabArray<FArrayBox> &mf,
 	BL_ASSERT(amrex::match(hdr.m_ba,mf.boxArray()));
     }
 
+    Real shardTime(0.0);
+    if(hdr.m_nshards > 0) {
+      // ---- each rank reads the fab locations of its own fabs
+      shardTime = amrex::second();
+      VisMF::ReadHeaderShards(mf_name, hdr, mf.IndexArray());
+      shardTime = amrex::second() - shardTime;
+    }
+
 #ifdef BL_USE_MPI
 
   // ---- This limits the number of concurrent readers per file.
@@ -1507,7 +2360,15 @@ VisMF::Read (FabArray<FArrayBox> &mf,
   int nProcs(ParallelDescriptor::NProcs());
   bool noFabHeader(NoFabHeader(hdr));
 
-  if(noFabHeader && useSynchronousReads) {
+  if(hdr.m_vers == VisMF::Header::CompressedFab_v1 || hdr.m_nshards > 0) {
+
+    // ---- the header (or its shards) has the offset of every fab,
+    // ---- so each rank reads and decodes its own fabs
+    for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+      VisMF::readFAB(mf, mfi.index(), mf_name, hdr);
+    }
+
+  } else if(noFabHeader && useSynchronousReads) {
 
     // ---- This code is only for reading in file order
     bool doConvert(hdr.m_writtenRD != FPC::NativeRealDescriptor());
@@ -1891,6 +2752,7 @@ VisMF::Read (FabArray<FArrayBox> &mf,
       amrex::AllPrint() << "FARead ::  nBoxes = " << hdr.m_ba.size()
                         << "  nMessages = " << messTotal << '\n'
                         << "FARead ::  hTime = " << (hEndTime - hStartTime) << '\n'
+                        << "FARead ::  shardTime = " << shardTime << '\n'
                         << "FARead ::  faCopyTime = " << faCopyTime << '\n'
                         << "FARead ::  mfReadTime = " << mfReadTime
                         << "  totalTime = " << totalTime << std::endl;
@@ -1950,6 +2812,12 @@ VisMF::Check (const std::string& mf_name)
         ifs.close();
     }
 
+    if(hdr.m_nshards > 0) {
+      Vector<int> allIndices(hdr.m_ba.size());
+      std::iota(allIndices.begin(), allIndices.end(), 0);
+      VisMF::ReadHeaderShards(mf_name, hdr, allIndices);
+    }
+
     if (verbose) {
         amrex::Print() << "hdr.version =  " << hdr.m_vers << "\n"
                        << "hdr.boxarray size =  " << hdr.m_ba.size() << "\n"
@@ -1960,10 +2828,13 @@ VisMF::Check (const std::string& mf_name)
                        << "FullHdrFileName = " << FullHdrFileName << "\n";
     }
 
-    if(hdr.m_vers != VisMF::Header::Version_v1) {
+    if(hdr.m_vers != VisMF::Header::Version_v1 &&
+       hdr.m_vers != VisMF::Header::CompressedFab_v1)
+    {
      v1 = false;
      if (verbose) {
-         amrex::Print() << "**** VisMF::Check currently only supports Version_v1." << std::endl;
+         amrex::Print() << "**** VisMF::Check currently only supports Version_v1"
+                        << " and CompressedFab_v1." << std::endl;
      }
     } else {
 
@@ -1985,17 +2856,29 @@ VisMF::Check (const std::string& mf_name)
 
       ifs.seekg(fod.m_head, std::ios::beg);
 
-      ifs >> c;
-      if(c != 'F') {
-        badFab = true;
-      }
-      ifs >> c;
-      if(c != 'A') {
-        badFab = true;
-      }
-      ifs >> c;
-      if(c != 'B') {
-        badFab = true;
+      if(hdr.m_vers == VisMF::Header::CompressedFab_v1) {
+        // ---- the block must be all there and hold the whole fab
+        Vector<char> cData(std::max(hdr.m_csize[i], 16L));
+        ifs.read(cData.dataPtr(), hdr.m_csize[i]);
+        const long nPts(amrex::grow(hdr.m_ba[i], hdr.m_ngrow).numPts());
+        if( ! ifs.good() || hdr.m_csize[i] < 16 ||
+            FabCompress::NumValues(cData.dataPtr()) != nPts * hdr.m_ncomp)
+        {
+          badFab = true;
+        }
+      } else {
+        ifs >> c;
+        if(c != 'F') {
+          badFab = true;
+        }
+        ifs >> c;
+        if(c != 'A') {
+          badFab = true;
+        }
+        ifs >> c;
+        if(c != 'B') {
+          badFab = true;
+        }
       }
       if(badFab) {
 	++nBadFabs;
@@ -2471,6 +3354,29 @@ VisMF::WriteAsync (const FabArray<FArrayBox>& mf, const std::string& mf_name)
     return af;
 }
 
+long
+VisMF::FinishAsyncWrites ()
+{
+    if(asyncWriteFutures.empty()) {
+      return 0;
+    }
+
+    BL_PROFILE("VisMF::FinishAsyncWrites()");
+
+    long bytesWritten(0);
+    for(auto& f : asyncWriteFutures) {
+      WriteAsyncStatus status = f.get();
+      bytesWritten += status.nbytes;
+      if(verbose > 1) {
+        amrex::AllPrint() << "VisMF::FinishAsyncWrites:  proc "
+                          << ParallelDescriptor::MyProc() << ":  " << status << '\n';
+      }
+    }
+    asyncWriteFutures.clear();
+
+    return bytesWritten;
+}
+
 std::ostream&
 operator<< (std::ostream& os, const WriteAsyncStatus& status)
 {
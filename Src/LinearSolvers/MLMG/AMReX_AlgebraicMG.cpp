@@ -0,0 +1,649 @@
+
+#include <AMReX_AlgebraicMG.H>
+#include <AMReX_Print.H>
+#include <AMReX_BLProfiler.H>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace amrex {
+
+namespace {
+
+// Rows are smoothed and vectors are reduced in fixed blocks, which keeps
+// the results independent of the number of threads.
+constexpr int block_size = 256;
+
+inline int num_blocks (int n) { return (n + block_size - 1) / block_size; }
+
+Real
+dot (const Vector<Real>& x, const Vector<Real>& y)
+{
+    const int n = x.size();
+    const int nb = num_blocks(n);
+    Vector<Real> partial(nb);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int ib = 0; ib < nb; ++ib) {
+        const int hi = std::min(n, (ib+1)*block_size);
+        Real s = 0.0;
+        for (int i = ib*block_size; i < hi; ++i) s += x[i]*y[i];
+        partial[ib] = s;
+    }
+    Real s = 0.0;
+    for (int ib = 0; ib < nb; ++ib) s += partial[ib];
+    return s;
+}
+
+Real
+norm_inf (const Vector<Real>& x)
+{
+    const int n = x.size();
+    Real m = 0.0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(max:m)
+#endif
+    for (int i = 0; i < n; ++i) m = std::max(m, std::abs(x[i]));
+    return m;
+}
+
+// y = x + a*y
+void
+xpay (const Vector<Real>& x, Real a, Vector<Real>& y)
+{
+    const int n = x.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; ++i) y[i] = x[i] + a*y[i];
+}
+
+// y += a*x
+void
+axpy (Real a, const Vector<Real>& x, Vector<Real>& y)
+{
+    const int n = x.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; ++i) y[i] += a*x[i];
+}
+
+Vector<Real>
+diagonal (const AlgebraicMG::CSR& A)
+{
+    Vector<Real> d(A.nrows, 0.0);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < A.nrows; ++i) {
+        for (int k = A.ptr[i]; k < A.ptr[i+1]; ++k) {
+            if (A.col[k] == i) d[i] += A.val[k];
+        }
+    }
+    return d;
+}
+
+AlgebraicMG::CSR
+transpose (const AlgebraicMG::CSR& A)
+{
+    AlgebraicMG::CSR T;
+    T.nrows = A.ncols;
+    T.ncols = A.nrows;
+    T.ptr.assign(T.nrows+1, 0);
+    const int nnz = A.nnz();
+    for (int k = 0; k < nnz; ++k) ++T.ptr[A.col[k]+1];
+    for (int i = 0; i < T.nrows; ++i) T.ptr[i+1] += T.ptr[i];
+    T.col.resize(nnz);
+    T.val.resize(nnz);
+    Vector<int> pos(T.ptr.begin(), T.ptr.end()-1);
+    for (int i = 0; i < A.nrows; ++i) {
+        for (int k = A.ptr[i]; k < A.ptr[i+1]; ++k) {
+            const int p = pos[A.col[k]]++;
+            T.col[p] = i;
+            T.val[p] = A.val[k];
+        }
+    }
+    return T;
+}
+
+// C = A B, row by row with a dense marker per thread (Gustavson)
+AlgebraicMG::CSR
+multiply (const AlgebraicMG::CSR& A, const AlgebraicMG::CSR& B)
+{
+    AlgebraicMG::CSR C;
+    C.nrows = A.nrows;
+    C.ncols = B.ncols;
+    C.ptr.assign(C.nrows+1, 0);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        Vector<int> marker(B.ncols, -1);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+        for (int i = 0; i < A.nrows; ++i) {
+            int nc = 0;
+            for (int ka = A.ptr[i]; ka < A.ptr[i+1]; ++ka) {
+                const int j = A.col[ka];
+                for (int kb = B.ptr[j]; kb < B.ptr[j+1]; ++kb) {
+                    if (marker[B.col[kb]] != i) {
+                        marker[B.col[kb]] = i;
+                        ++nc;
+                    }
+                }
+            }
+            C.ptr[i+1] = nc;
+        }
+    }
+
+    for (int i = 0; i < C.nrows; ++i) C.ptr[i+1] += C.ptr[i];
+    C.col.resize(C.nnz());
+    C.val.resize(C.nnz());
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        Vector<int> pos(B.ncols, -1);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+        for (int i = 0; i < A.nrows; ++i) {
+            const int start = C.ptr[i];
+            int end = start;
+            for (int ka = A.ptr[i]; ka < A.ptr[i+1]; ++ka) {
+                const int j = A.col[ka];
+                const Real a = A.val[ka];
+                for (int kb = B.ptr[j]; kb < B.ptr[j+1]; ++kb) {
+                    const int c = B.col[kb];
+                    if (pos[c] < start) {
+                        pos[c] = end;
+                        C.col[end] = c;
+                        C.val[end] = a * B.val[kb];
+                        ++end;
+                    } else {
+                        C.val[pos[c]] += a * B.val[kb];
+                    }
+                }
+            }
+        }
+    }
+
+    return C;
+}
+
+}
+
+void
+AlgebraicMG::CSR::apply (const Real* x, Real* y) const
+{
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < nrows; ++i) {
+        Real s = 0.0;
+        for (int k = ptr[i]; k < ptr[i+1]; ++k) s += val[k] * x[col[k]];
+        y[i] = s;
+    }
+}
+
+void
+AlgebraicMG::buildProlongator (const CSR& A, CSR& P) const
+{
+    BL_PROFILE("AlgebraicMG::buildProlongator()");
+
+    const int n = A.nrows;
+    const Vector<Real> d = diagonal(A);
+
+    // strong connections: |a_ij| >= theta sqrt(|a_ii a_jj|), same component
+    CSR S;
+    S.nrows = S.ncols = n;
+    S.ptr.assign(n+1, 0);
+    auto strong = [&] (int i, int k) -> bool
+    {
+        const int j = A.col[k];
+        return j != i && (j-i) % ncomp == 0 && A.val[k] != 0.0
+            && std::abs(A.val[k]) >= strength_threshold * std::sqrt(std::abs(d[i]*d[j]));
+    };
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; ++i) {
+        int ns = 0;
+        for (int k = A.ptr[i]; k < A.ptr[i+1]; ++k) {
+            if (strong(i,k)) ++ns;
+        }
+        S.ptr[i+1] = ns;
+    }
+    for (int i = 0; i < n; ++i) S.ptr[i+1] += S.ptr[i];
+    S.col.resize(S.ptr[n]);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; ++i) {
+        int p = S.ptr[i];
+        for (int k = A.ptr[i]; k < A.ptr[i+1]; ++k) {
+            if (strong(i,k)) S.col[p++] = A.col[k];
+        }
+    }
+
+    // greedy aggregation: whole free neighborhoods first, then attach the
+    // rest to a neighboring aggregate
+    Vector<int> agg(n, -1);
+    int nagg = 0;
+    for (int i = 0; i < n; ++i) {
+        if (agg[i] != -1) continue;
+        bool free = true;
+        for (int k = S.ptr[i]; k < S.ptr[i+1] && free; ++k) {
+            free = agg[S.col[k]] == -1;
+        }
+        if (free) {
+            agg[i] = nagg;
+            for (int k = S.ptr[i]; k < S.ptr[i+1]; ++k) agg[S.col[k]] = nagg;
+            ++nagg;
+        }
+    }
+    const Vector<int> agg1 = agg;
+    for (int i = 0; i < n; ++i) {
+        if (agg[i] != -1) continue;
+        for (int k = S.ptr[i]; k < S.ptr[i+1]; ++k) {
+            if (agg1[S.col[k]] != -1) {
+                agg[i] = agg1[S.col[k]];
+                break;
+            }
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        if (agg[i] != -1) continue;
+        agg[i] = nagg;
+        for (int k = S.ptr[i]; k < S.ptr[i+1]; ++k) {
+            if (agg[S.col[k]] == -1) agg[S.col[k]] = nagg;
+        }
+        ++nagg;
+    }
+
+    // tentative prolongator: the constant on each aggregate, normalized
+    Vector<int> aggsize(nagg, 0);
+    for (int i = 0; i < n; ++i) ++aggsize[agg[i]];
+    Vector<Real> t(n);
+    for (int i = 0; i < n; ++i) t[i] = 1.0/std::sqrt(static_cast<Real>(aggsize[agg[i]]));
+
+    Vector<Real> dinv(n);
+    for (int i = 0; i < n; ++i) dinv[i] = (d[i] != 0.0) ? 1.0/d[i] : 0.0;
+
+    // spectral radius of D^{-1} A by power iteration
+    Real rho = 1.0;
+    {
+        Vector<Real> v(n), w(n);
+        for (int i = 0; i < n; ++i) v[i] = 1.0 + 0.5*std::sin(static_cast<Real>(i));
+        for (int it = 0; it < 15; ++it) {
+            const Real vnorm = std::sqrt(dot(v,v));
+            if (vnorm == 0.0) break;
+            A.apply(v.data(), w.data());
+            for (int i = 0; i < n; ++i) w[i] *= dinv[i];
+            rho = std::sqrt(dot(w,w)) / vnorm;
+            std::swap(v, w);
+        }
+        if (rho <= 0.0) rho = 1.0;
+    }
+    const Real omega = (4.0/3.0) / rho;
+
+    // P = (I - omega D^{-1} A) T
+    P.nrows = n;
+    P.ncols = nagg;
+    P.ptr.assign(n+1, 0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        Vector<int> marker(nagg, -1);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+        for (int i = 0; i < n; ++i) {
+            int nc = 1;
+            marker[agg[i]] = i;
+            for (int k = A.ptr[i]; k < A.ptr[i+1]; ++k) {
+                const int c = agg[A.col[k]];
+                if (marker[c] != i) {
+                    marker[c] = i;
+                    ++nc;
+                }
+            }
+            P.ptr[i+1] = nc;
+        }
+    }
+    for (int i = 0; i < n; ++i) P.ptr[i+1] += P.ptr[i];
+    P.col.resize(P.nnz());
+    P.val.resize(P.nnz());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        Vector<int> pos(nagg, -1);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+        for (int i = 0; i < n; ++i) {
+            const int start = P.ptr[i];
+            int end = start;
+            pos[agg[i]] = end;
+            P.col[end] = agg[i];
+            P.val[end] = t[i];
+            ++end;
+            const Real f = -omega * dinv[i];
+            for (int k = A.ptr[i]; k < A.ptr[i+1]; ++k) {
+                const int j = A.col[k];
+                const int c = agg[j];
+                if (pos[c] < start) {
+                    pos[c] = end;
+                    P.col[end] = c;
+                    P.val[end] = f * A.val[k] * t[j];
+                    ++end;
+                } else {
+                    P.val[pos[c]] += f * A.val[k] * t[j];
+                }
+            }
+        }
+    }
+}
+
+void
+AlgebraicMG::setup (CSR&& A)
+{
+    BL_PROFILE("AlgebraicMG::setup()");
+
+    m_levels.clear();
+    m_levels.emplace_back();
+    m_levels[0].A = std::move(A);
+
+    while (true)
+    {
+        const int lev = m_levels.size() - 1;
+        const CSR& Af = m_levels[lev].A;
+        if (Af.nrows <= max_coarse_size || lev+1 >= max_levels) break;
+
+        CSR P;
+        buildProlongator(Af, P);
+        if (P.ncols == 0 || P.ncols > 0.9*Af.nrows) break;  // not coarsening
+
+        CSR R = transpose(P);
+        CSR Ac = multiply(R, multiply(Af, P));
+
+        m_levels[lev].P = std::move(P);
+        m_levels[lev].R = std::move(R);
+        m_levels.emplace_back();
+        m_levels.back().A = std::move(Ac);
+    }
+
+    for (auto& L : m_levels) {
+        const int n = L.A.nrows;
+        L.x.assign(n, 0.0);
+        L.b.assign(n, 0.0);
+        L.r.assign(n, 0.0);
+        L.xold.assign(n, 0.0);
+    }
+
+    // dense LU with partial pivoting of the coarsest level; null pivots,
+    // from a singular operator, pin their unknown to zero
+    const CSR& Ac = m_levels.back().A;
+    const int n = Ac.nrows;
+    m_lu.assign(static_cast<long>(n)*n, 0.0);
+    m_piv.resize(n);
+    m_null_pivot.assign(n, 0);
+    Real amax = 0.0;
+    for (int i = 0; i < n; ++i) {
+        for (int k = Ac.ptr[i]; k < Ac.ptr[i+1]; ++k) {
+            m_lu[static_cast<long>(i)*n+Ac.col[k]] += Ac.val[k];
+            amax = std::max(amax, std::abs(Ac.val[k]));
+        }
+    }
+    const Real tiny = n * 1.e-14 * amax;
+    for (int k = 0; k < n; ++k)
+    {
+        int p = k;
+        for (int i = k+1; i < n; ++i) {
+            if (std::abs(m_lu[static_cast<long>(i)*n+k]) > std::abs(m_lu[static_cast<long>(p)*n+k])) p = i;
+        }
+        m_piv[k] = p;
+        if (p != k) {
+            for (int j = 0; j < n; ++j) std::swap(m_lu[static_cast<long>(k)*n+j], m_lu[static_cast<long>(p)*n+j]);
+        }
+        Real* rowk = &m_lu[static_cast<long>(k)*n];
+        if (std::abs(rowk[k]) <= tiny) {
+            m_null_pivot[k] = 1;
+            rowk[k] = 1.0;
+            for (int j = k+1; j < n; ++j) rowk[j] = 0.0;
+            for (int i = k+1; i < n; ++i) m_lu[static_cast<long>(i)*n+k] = 0.0;
+            continue;
+        }
+#ifdef _OPENMP
+#pragma omp parallel for if (n-k > 64)
+#endif
+        for (int i = k+1; i < n; ++i) {
+            Real* rowi = &m_lu[static_cast<long>(i)*n];
+            const Real f = rowi[k] / rowk[k];
+            rowi[k] = f;
+            for (int j = k+1; j < n; ++j) rowi[j] -= f * rowk[j];
+        }
+    }
+
+    if (verbose > 0)
+    {
+        amrex::Print() << "AlgebraicMG: " << m_levels.size() << " levels, operator complexity "
+                       << operatorComplexity() << "\n";
+        if (verbose > 1) {
+            for (int lev = 0; lev < m_levels.size(); ++lev) {
+                amrex::Print() << "AlgebraicMG:   level " << lev << ": "
+                               << m_levels[lev].A.nrows << " rows, "
+                               << m_levels[lev].A.nnz() << " nonzeros\n";
+            }
+        }
+    }
+}
+
+Real
+AlgebraicMG::operatorComplexity () const
+{
+    if (m_levels.empty() || m_levels[0].A.nnz() == 0) return 0.0;
+    Real total = 0.0;
+    for (const auto& L : m_levels) total += L.A.nnz();
+    return total / m_levels[0].A.nnz();
+}
+
+void
+AlgebraicMG::smooth (int lev, bool forward)
+{
+    Level& L = m_levels[lev];
+    const CSR& A = L.A;
+    const int n = A.nrows;
+    const int nb = num_blocks(n);
+    std::copy(L.x.begin(), L.x.end(), L.xold.begin());
+
+    // hybrid Gauss-Seidel: sequential within a block, Jacobi between blocks
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int ib = 0; ib < nb; ++ib) {
+        const int lo = ib*block_size;
+        const int hi = std::min(n, lo+block_size);
+        for (int ii = 0; ii < hi-lo; ++ii) {
+            const int i = forward ? lo+ii : hi-1-ii;
+            Real s = L.b[i];
+            Real diag = 0.0;
+            for (int k = A.ptr[i]; k < A.ptr[i+1]; ++k) {
+                const int j = A.col[k];
+                if (j == i) {
+                    diag += A.val[k];
+                } else {
+                    s -= A.val[k] * ((j >= lo && j < hi) ? L.x[j] : L.xold[j]);
+                }
+            }
+            if (diag != 0.0) L.x[i] = s / diag;
+        }
+    }
+}
+
+void
+AlgebraicMG::coarseSolve ()
+{
+    Level& L = m_levels.back();
+    const int n = L.A.nrows;
+    Vector<Real>& x = L.x;
+    x = L.b;
+    for (int k = 0; k < n; ++k) {
+        std::swap(x[k], x[m_piv[k]]);
+        for (int i = k+1; i < n; ++i) x[i] -= m_lu[static_cast<long>(i)*n+k] * x[k];
+    }
+    for (int k = n-1; k >= 0; --k) {
+        if (m_null_pivot[k]) {
+            x[k] = 0.0;
+            continue;
+        }
+        Real s = x[k];
+        for (int j = k+1; j < n; ++j) s -= m_lu[static_cast<long>(k)*n+j] * x[j];
+        x[k] = s / m_lu[static_cast<long>(k)*n+k];
+    }
+}
+
+// V(1,1) cycle for levels[lev].b into levels[lev].x, from a zero guess
+void
+AlgebraicMG::vcycle (int lev)
+{
+    if (lev == m_levels.size()-1) {
+        coarseSolve();
+        return;
+    }
+
+    Level& L = m_levels[lev];
+    Level& C = m_levels[lev+1];
+    const int n = L.A.nrows;
+
+    std::fill(L.x.begin(), L.x.end(), 0.0);
+    smooth(lev, true);
+
+    L.A.apply(L.x.data(), L.r.data());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; ++i) L.r[i] = L.b[i] - L.r[i];
+    L.R.apply(L.r.data(), C.b.data());
+
+    vcycle(lev+1);
+
+    L.P.apply(C.x.data(), L.r.data());
+    axpy(1.0, L.r, L.x);
+
+    smooth(lev, false);
+}
+
+int
+AlgebraicMG::solve (Vector<Real>& x, const Vector<Real>& b, Real eps_rel, Real eps_abs, int maxiter)
+{
+    BL_PROFILE("AlgebraicMG::solve()");
+
+    AMREX_ASSERT(isSetUp());
+
+    const CSR& A = m_levels[0].A;
+    const int n = A.nrows;
+    Level& L0 = m_levels[0];
+
+    auto precond = [&] (const Vector<Real>& in, Vector<Real>& out)
+    {
+        std::copy(in.begin(), in.end(), L0.b.begin());
+        vcycle(0);
+        std::copy(L0.x.begin(), L0.x.end(), out.begin());
+    };
+
+    Vector<Real> r(n), rh(n), p(n), v(n), s(n), t(n), ph(n), sh(n);
+
+    A.apply(x.data(), r.data());
+    for (int i = 0; i < n; ++i) r[i] = b[i] - r[i];
+    rh = r;
+
+    Real rnorm = norm_inf(r);
+    const Real rnorm0 = rnorm;
+    m_num_iters = 0;
+    m_final_residual = rnorm;
+
+    if (verbose > 0) {
+        amrex::Print() << "AlgebraicMG: Initial error (error0) = " << rnorm0 << "\n";
+    }
+    if (rnorm0 == 0.0 || rnorm0 < eps_abs) return 0;
+
+    int ret = 0;
+    int nit = 1;
+    Real rho_1 = 0.0, alpha = 0.0, omega = 0.0;
+    for (; nit <= maxiter; ++nit)
+    {
+        const Real rho = dot(rh, r);
+        if (rho == 0.0) {
+            ret = 1; break;
+        }
+        if (nit == 1) {
+            p = r;
+        } else {
+            const Real beta = (rho/rho_1)*(alpha/omega);
+            axpy(-omega, v, p);
+            xpay(r, beta, p);
+        }
+        precond(p, ph);
+        A.apply(ph.data(), v.data());
+        const Real rhv = dot(rh, v);
+        if (rhv == 0.0) {
+            ret = 1; break;
+        }
+        alpha = rho/rhv;
+        axpy(alpha, ph, x);
+        s = r;
+        axpy(-alpha, v, s);
+
+        rnorm = norm_inf(s);
+        if (rnorm < eps_rel*rnorm0 || rnorm < eps_abs) break;
+
+        precond(s, sh);
+        A.apply(sh.data(), t.data());
+        const Real tt = dot(t, t);
+        if (tt == 0.0) {
+            ret = 1; break;
+        }
+        omega = dot(t, s)/tt;
+        axpy(omega, sh, x);
+        r = s;
+        axpy(-omega, t, r);
+
+        rnorm = norm_inf(r);
+        if (verbose > 2) {
+            amrex::Print() << "AlgebraicMG: Iteration " << std::setw(4) << nit
+                           << " rel. err. " << rnorm/rnorm0 << "\n";
+        }
+        if (rnorm < eps_rel*rnorm0 || rnorm < eps_abs) break;
+        if (omega == 0.0) {
+            ret = 1; break;
+        }
+        rho_1 = rho;
+    }
+
+    m_num_iters = std::min(nit, maxiter);
+    m_final_residual = rnorm;
+
+    if (verbose > 0) {
+        amrex::Print() << "AlgebraicMG: Final: Iteration " << std::setw(4) << m_num_iters
+                       << " rel. err. " << rnorm/rnorm0 << "\n";
+    }
+
+    if (ret == 0 && rnorm > eps_rel*rnorm0 && rnorm > eps_abs) ret = 8;
+    return ret;
+}
+
+}
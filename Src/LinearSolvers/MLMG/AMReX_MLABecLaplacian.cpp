@@ -57,6 +57,7 @@ MLABecLaplacian::~MLABecLaplacian ()
 void
 MLABecLaplacian::setScalars (Real a, Real b) noexcept
 {
+    if (a != m_a_scalar || b != m_b_scalar) coeffsChanged();
     m_a_scalar = a;
     m_b_scalar = b;
     if (a == 0.0)
@@ -71,8 +72,9 @@ MLABecLaplacian::setScalars (Real a, Real b) noexcept
 void
 MLABecLaplacian::setACoeffs (int amrlev, const MultiFab& alpha)
 {
-    MultiFab::Copy(m_a_coeffs[amrlev][0], alpha, 0, 0, 1, 0);
-    m_needs_update = true;
+    if (copyCoeffs(m_a_coeffs[amrlev][0], 0, alpha, 0, 1)) {
+        m_needs_update = true;
+    }
 }
 
 void
@@ -80,12 +82,15 @@ MLABecLaplacian::setBCoeffs (int amrlev,
                              const Array<MultiFab const*,AMREX_SPACEDIM>& beta)
 {
     const int ncomp = getNComp();
+    bool changed = false;
     for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
         for (int icomp = 0; icomp < ncomp; ++icomp) {
-            MultiFab::Copy(m_b_coeffs[amrlev][0][idim], *beta[idim], 0, icomp, 1, 0);
+            changed = copyCoeffs(m_b_coeffs[amrlev][0][idim], icomp, *beta[idim], 0, 1) || changed;
         }
     }
-    m_needs_update = true;
+    if (changed) {
+        m_needs_update = true;
+    }
 }
 
 void
@@ -286,6 +291,14 @@ void
 MLABecLaplacian::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs, int redblack) const
 {
     BL_PROFILE("MLABecLaplacian::Fsmooth()");
+    FsmoothRegion(amrlev, mglev, sol, rhs, redblack, MFItInfo::AllCells, IntVect::TheZeroVector());
+}
+
+void
+MLABecLaplacian::FsmoothRegion (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs, int redblack,
+                                MFItInfo::Region region, const IntVect& nghost) const
+{
+    BL_PROFILE("MLABecLaplacian::FsmoothRegion()");
 
     const MultiFab& acoef = m_a_coeffs[amrlev][mglev];
     AMREX_D_TERM(const MultiFab& bxcoef = m_b_coeffs[amrlev][mglev][0];,
@@ -327,6 +340,7 @@ MLABecLaplacian::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab&
 
     MFItInfo mfi_info;
     if (Gpu::notInLaunchRegion()) mfi_info.EnableTiling().SetDynamic(true);
+    mfi_info.SetRegion(region, nghost);
 
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
@@ -0,0 +1,414 @@
+
+#include <AMReX_MLAMGSolver.H>
+#include <AMReX_MLNodeLinOp.H>
+#include <AMReX_MultiFabUtil.H>
+#include <AMReX_ParallelDescriptor.H>
+
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace amrex {
+
+namespace {
+
+Vector<int>
+all_counts (int n, MPI_Comm comm)
+{
+#ifdef BL_USE_MPI
+    int nprocs;
+    MPI_Comm_size(comm, &nprocs);
+    Vector<int> counts(nprocs);
+    MPI_Allgather(&n, 1, MPI_INT, counts.data(), 1, MPI_INT, comm);
+    return counts;
+#else
+    return Vector<int>{n};
+#endif
+}
+
+template <class T>
+Vector<T>
+all_gatherv (const Vector<T>& local, const Vector<int>& counts, MPI_Comm comm)
+{
+#ifdef BL_USE_MPI
+    Vector<int> displs(counts.size(), 0);
+    for (int i = 1; i < counts.size(); ++i) displs[i] = displs[i-1] + counts[i-1];
+    Vector<T> all(displs.back() + counts.back());
+    MPI_Allgatherv(local.data(), local.size(), ParallelDescriptor::Mpi_typemap<T>::type(),
+                   all.data(), counts.data(), displs.data(),
+                   ParallelDescriptor::Mpi_typemap<T>::type(), comm);
+    return all;
+#else
+    return local;
+#endif
+}
+
+// Colors for probing: points of the same color are at least 2r+1 apart in
+// some direction, periodic images included, so no stencil of radius r
+// touches two of them.
+struct Coloring
+{
+    int m;
+    Array<int,3> period {{0,0,0}};  // 0 if not periodic
+    Array<int,3> nfull  {{0,0,0}};
+    Array<int,3> ncolor {{1,1,1}};
+
+    Coloring (const Geometry& geom, bool cell_centered, int r)
+        : m(2*r+1)
+    {
+        const Box& domain = geom.Domain();
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            const int n = domain.length(idim);
+            if (geom.isPeriodic(idim)) {
+                period[idim] = n;
+                nfull[idim] = (n/m)*m;
+                ncolor[idim] = (nfull[idim] > 0 ? m : 0) + n - nfull[idim];
+            } else {
+                ncolor[idim] = std::min(m, cell_centered ? n : n+1);
+            }
+        }
+    }
+
+    int numColors () const noexcept { return ncolor[0]*ncolor[1]*ncolor[2]; }
+
+    int color1d (int i, int idim) const noexcept
+    {
+        const int n = period[idim];
+        if (n > 0) {
+            i = ((i % n) + n) % n;
+            return (i < nfull[idim]) ? i % m : (nfull[idim] > 0 ? m : 0) + i - nfull[idim];
+        } else {
+            return ((i % m) + m) % m;
+        }
+    }
+
+    int operator() (int i, int j, int k) const noexcept
+    {
+        return color1d(i,0)
+#if (AMREX_SPACEDIM > 1)
+            + ncolor[0]*(color1d(j,1)
+#if (AMREX_SPACEDIM > 2)
+                         + ncolor[1]*color1d(k,2)
+#endif
+                )
+#endif
+            ;
+    }
+};
+
+}
+
+MLAMGSolver::MLAMGSolver (MLLinOp& a_lp)
+    : Lp(a_lp),
+      amrlev(0),
+      mglev(a_lp.NMGLevels(0)-1)
+{
+}
+
+MLAMGSolver::~MLAMGSolver ()
+{
+}
+
+bool
+MLAMGSolver::isRow (const MFIter& mfi, int i, int j, int k, const Array4<int const>& id) const
+{
+    return id(i,j,k) >= 0 && (m_owner == nullptr || (*m_owner)[mfi](IntVect(AMREX_D_DECL(i,j,k))));
+}
+
+void
+MLAMGSolver::numberUnknowns (const MultiFab& x)
+{
+    const BoxArray& ba = x.boxArray();
+    const DistributionMapping& dm = x.DistributionMap();
+    const Geometry& geom = Lp.Geom(amrlev, mglev);
+
+    const iMultiFab* dirichlet = nullptr;
+    m_owner = nullptr;
+    if (!Lp.isCellCentered()) {
+        auto nodelinop = dynamic_cast<MLNodeLinOp*>(&Lp);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(nodelinop, "MLAMGSolver: unsupported MLLinOp");
+        m_owner = nodelinop->m_owner_mask[amrlev][mglev].get();
+        dirichlet = nodelinop->m_dirichlet_mask[amrlev][mglev].get();
+    }
+
+    m_id.define(ba, dm, 1, m_nghost);
+    m_id.setVal(-1);
+
+    // number this rank's unknowns grid by grid; nodes shared by several
+    // grids are numbered by their owner only
+    LayoutData<int> nrows_grid(ba, dm);
+    int nrows_proc = 0;
+#ifdef _OPENMP
+#pragma omp parallel reduction(+:nrows_proc)
+#endif
+    for (MFIter mfi(m_id); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        const auto& id = m_id.array(mfi);
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        int n = 0;
+        for         (int k = lo.z; k <= hi.z; ++k) {
+            for     (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    const IntVect iv(AMREX_D_DECL(i,j,k));
+                    if (m_owner == nullptr || ((*m_owner)[mfi](iv) && !(*dirichlet)[mfi](iv))) {
+                        id(i,j,k) = n++;
+                    }
+                }
+            }
+        }
+        nrows_grid[mfi] = n;
+        nrows_proc += n;
+    }
+
+    MPI_Comm comm = Lp.BottomCommunicator();
+    m_nrows_allprocs = all_counts(nrows_proc * m_ncomp, comm);
+    int myproc = 0;
+#ifdef BL_USE_MPI
+    MPI_Comm_rank(comm, &myproc);
+#endif
+    m_row_begin = 0;
+    for (int i = 0; i < myproc; ++i) m_row_begin += m_nrows_allprocs[i];
+    m_nrows_proc = m_nrows_allprocs[myproc];
+
+    // ids are node or cell numbers; unknown n of cell id is id*ncomp+n
+    int offset = m_row_begin / m_ncomp;
+    LayoutData<int> grid_offset(ba, dm);
+    for (MFIter mfi(nrows_grid); mfi.isValid(); ++mfi) {
+        grid_offset[mfi] = offset;
+        offset += nrows_grid[mfi];
+    }
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(m_id); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        const auto& id = m_id.array(mfi);
+        const int os = grid_offset[mfi];
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        for         (int k = lo.z; k <= hi.z; ++k) {
+            for     (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    if (id(i,j,k) >= 0) id(i,j,k) += os;
+                }
+            }
+        }
+    }
+
+    if (m_owner) amrex::OverrideSync(m_id, *m_owner, geom.periodicity());
+    m_id.FillBoundary(geom.periodicity());
+}
+
+void
+MLAMGSolver::setup (const MultiFab& x)
+{
+    BL_PROFILE("MLAMGSolver::setup()");
+
+    m_ncomp = Lp.getNComp();
+    m_nghost = (Lp.isCellCentered() && Lp.getMaxOrder() > 3) ? 2 : 1;
+
+    numberUnknowns(x);
+
+    const BoxArray& ba = x.boxArray();
+    const DistributionMapping& dm = x.DistributionMap();
+    const auto& factory = x.Factory();
+    const int ncomp = m_ncomp;
+    const int r = m_nghost;
+    const Coloring color(Lp.Geom(amrlev, mglev), Lp.isCellCentered(), r);
+    const Dim3 rr{r, AMREX_SPACEDIM > 1 ? r : 0, AMREX_SPACEDIM > 2 ? r : 0};
+
+    MultiFab in (ba, dm, ncomp, x.nGrow(), MFInfo(), factory);
+    MultiFab out(ba, dm, ncomp, 0, MFInfo(), factory);
+
+    // the nonzeros of this rank's rows, by local row
+    Vector<Vector<std::pair<int,Real> > > rows(m_nrows_proc);
+    const long row_begin = m_row_begin;
+
+    for (int c = 0; c < color.numColors(); ++c)
+    {
+        for (int n = 0; n < ncomp; ++n)
+        {
+            in.setVal(0.0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            for (MFIter mfi(in); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.validbox();
+                const auto& id = m_id.const_array(mfi);
+                const auto& a = in.array(mfi);
+                const auto lo = amrex::lbound(bx);
+                const auto hi = amrex::ubound(bx);
+                for         (int k = lo.z; k <= hi.z; ++k) {
+                    for     (int j = lo.y; j <= hi.y; ++j) {
+                        for (int i = lo.x; i <= hi.x; ++i) {
+                            if (id(i,j,k) >= 0 && color(i,j,k) == c) a(i,j,k,n) = 1.0;
+                        }
+                    }
+                }
+            }
+
+            Lp.apply(amrlev, mglev, out, in, MLLinOp::BCMode::Homogeneous,
+                     MLLinOp::StateMode::Correction);
+
+            // column n of the colored unknown next to each row
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            for (MFIter mfi(out); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.validbox();
+                const auto& id = m_id.const_array(mfi);
+                const auto& a = out.const_array(mfi);
+                const auto lo = amrex::lbound(bx);
+                const auto hi = amrex::ubound(bx);
+                for         (int k = lo.z; k <= hi.z; ++k) {
+                    for     (int j = lo.y; j <= hi.y; ++j) {
+                        for (int i = lo.x; i <= hi.x; ++i) {
+                            if (!isRow(mfi,i,j,k,id)) continue;
+                            int col = -1;
+                            for         (int kk = k-rr.z; kk <= k+rr.z && col < 0; ++kk) {
+                                for     (int jj = j-rr.y; jj <= j+rr.y && col < 0; ++jj) {
+                                    for (int ii = i-rr.x; ii <= i+rr.x && col < 0; ++ii) {
+                                        if (id(ii,jj,kk) >= 0 && color(ii,jj,kk) == c) {
+                                            col = id(ii,jj,kk)*ncomp + n;
+                                        }
+                                    }
+                                }
+                            }
+                            if (col < 0) continue;
+                            for (int m = 0; m < ncomp; ++m) {
+                                const Real v = a(i,j,k,m);
+                                if (v != 0.0) {
+                                    rows[id(i,j,k)*ncomp + m - row_begin].emplace_back(col, v);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // rows without any entry (e.g., covered cells) get a unit diagonal
+    Vector<int> rownnz(m_nrows_proc);
+    Vector<int> cols;
+    Vector<Real> vals;
+    for (long irow = 0; irow < m_nrows_proc; ++irow) {
+        auto& row = rows[irow];
+        if (row.empty()) row.emplace_back(row_begin+irow, 1.0);
+        std::sort(row.begin(), row.end(),
+                  [] (const std::pair<int,Real>& a, const std::pair<int,Real>& b)
+                  { return a.first < b.first; });
+        rownnz[irow] = row.size();
+        for (const auto& e : row) {
+            cols.push_back(e.first);
+            vals.push_back(e.second);
+        }
+    }
+    rows.clear();
+
+    MPI_Comm comm = Lp.BottomCommunicator();
+    const Vector<int> nnz_allprocs = all_counts(cols.size(), comm);
+
+    AlgebraicMG::CSR A;
+    {
+        const Vector<int> allnnz = all_gatherv(rownnz, m_nrows_allprocs, comm);
+        A.nrows = A.ncols = allnnz.size();
+        A.ptr.resize(A.nrows+1);
+        A.ptr[0] = 0;
+        for (int i = 0; i < A.nrows; ++i) A.ptr[i+1] = A.ptr[i] + allnnz[i];
+    }
+    A.col = all_gatherv(cols, nnz_allprocs, comm);
+    A.val = all_gatherv(vals, nnz_allprocs, comm);
+
+    if (verbose > 0) {
+        amrex::Print() << "MLAMGSolver: assembled " << A.nrows << " rows, " << A.nnz()
+                       << " nonzeros with " << color.numColors()*ncomp << " applies\n";
+    }
+
+    m_amg.setVerbose(verbose);
+    m_amg.setNComp(ncomp);
+    m_amg.setup(std::move(A));
+}
+
+void
+MLAMGSolver::gatherRHS (const MultiFab& r, Vector<Real>& rhs) const
+{
+    Vector<Real> local(m_nrows_proc);
+    const long row_begin = m_row_begin;
+    const int ncomp = m_ncomp;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(r); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        const auto& id = m_id.const_array(mfi);
+        const auto& a = r.const_array(mfi);
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        for         (int k = lo.z; k <= hi.z; ++k) {
+            for     (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    if (isRow(mfi,i,j,k,id)) {
+                        for (int n = 0; n < ncomp; ++n) {
+                            local[id(i,j,k)*ncomp + n - row_begin] = a(i,j,k,n);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    rhs = all_gatherv(local, m_nrows_allprocs, Lp.BottomCommunicator());
+}
+
+int
+MLAMGSolver::solve (MultiFab& x, const MultiFab& b, Real eps_rel, Real eps_abs)
+{
+    BL_PROFILE("MLAMGSolver::solve()");
+
+    if (!isSetUp()) setup(x);
+
+    const int ncomp = m_ncomp;
+    MultiFab r(b.boxArray(), b.DistributionMap(), ncomp, 0, MFInfo(), b.Factory());
+    Lp.correctionResidual(amrlev, mglev, r, x, b, MLLinOp::BCMode::Homogeneous);
+
+    Vector<Real> rhs;
+    gatherRHS(r, rhs);
+    Vector<Real> e(rhs.size(), 0.0);
+
+    const int ret = m_amg.solve(e, rhs, eps_rel, eps_abs, maxiter);
+
+    // every rank has the whole correction; shared nodes carry the owner's id
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(r); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        const auto& id = m_id.const_array(mfi);
+        const auto& a = r.array(mfi);
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        for         (int k = lo.z; k <= hi.z; ++k) {
+            for     (int j = lo.y; j <= hi.y; ++j) {
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    for (int n = 0; n < ncomp; ++n) {
+                        a(i,j,k,n) = (id(i,j,k) >= 0) ? e[id(i,j,k)*ncomp + n] : 0.0;
+                    }
+                }
+            }
+        }
+    }
+    MultiFab::Add(x, r, 0, 0, ncomp, 0);
+
+    return ret;
+}
+
+}
@@ -48,6 +48,124 @@ sxay (MultiFab&       ss,
     sxay(ss,xx,a,yy,0,nghost);
 }
 
+#ifdef BL_USE_MPI
+// Each element of the datatype is a run of Reals: sum all but the last,
+// which is a max.
+void
+sum_max (void* invec, void* inoutvec, int* len, MPI_Datatype* dtype)
+{
+    int nbytes;
+    MPI_Type_size(*dtype, &nbytes);
+    const int n = nbytes / sizeof(Real);
+    const Real* in = static_cast<const Real*>(invec);
+    Real* inout = static_cast<Real*>(inoutvec);
+    for (int e = 0; e < *len; ++e, in += n, inout += n) {
+        for (int i = 0; i < n-1; ++i) inout[i] += in[i];
+        inout[n-1] = std::max(inout[n-1], in[n-1]);
+    }
+}
+#endif
+
+//
+// The reductions of one iteration of the pipelined solvers as a single
+// allreduce: nsum sums and one max (the residual norm).  start() posts it
+// and wait() completes it, so that an operator apply placed in between
+// overlaps with the communication.  Blocking without MPI-3.
+//
+class FusedReduce
+{
+public:
+    FusedReduce (int nsum, MPI_Comm comm)
+        : m_buf(nsum+1, 0.0), m_comm(comm)
+    {
+#ifdef BL_USE_MPI
+        MPI_Type_contiguous(nsum+1, ParallelDescriptor::Mpi_typemap<Real>::type(), &m_type);
+        MPI_Type_commit(&m_type);
+        MPI_Op_create(sum_max, 1, &m_op);
+#endif
+    }
+
+    ~FusedReduce ()
+    {
+#ifdef BL_USE_MPI
+        MPI_Op_free(&m_op);
+        MPI_Type_free(&m_type);
+#endif
+    }
+
+    FusedReduce (const FusedReduce&) = delete;
+    FusedReduce& operator= (const FusedReduce&) = delete;
+
+    Real& operator[] (int i) { return m_buf[i]; }
+    Real& normInf () { return m_buf.back(); }
+
+    void start ()
+    {
+#ifdef BL_USE_MPI
+        m_send = m_buf;
+#if (MPI_VERSION >= 3)
+        MPI_Iallreduce(m_send.data(), m_buf.data(), 1, m_type, m_op, m_comm, &m_req);
+#else
+        BL_PROFILE("MLCGSolver::ParallelAllReduce");
+        MPI_Allreduce(m_send.data(), m_buf.data(), 1, m_type, m_op, m_comm);
+#endif
+#endif
+    }
+
+    void wait ()
+    {
+#if defined(BL_USE_MPI) && (MPI_VERSION >= 3)
+        BL_PROFILE("MLCGSolver::ParallelAllReduce");
+        MPI_Wait(&m_req, MPI_STATUS_IGNORE);
+#endif
+    }
+
+private:
+    Vector<Real> m_buf;
+    Vector<Real> m_send;
+    MPI_Comm m_comm;
+#ifdef BL_USE_MPI
+    MPI_Datatype m_type;
+    MPI_Op m_op;
+#if (MPI_VERSION >= 3)
+    MPI_Request m_req;
+#endif
+#endif
+};
+
+// Solves the n x n system a x = b in place for nrhs right-hand sides
+// stored row by row in b, by Gaussian elimination with partial pivoting.
+// Returns false if a is singular.
+bool
+solve_dense (Vector<Real>& a, Vector<Real>& b, int n, int nrhs)
+{
+    for (int k = 0; k < n; ++k)
+    {
+        int piv = k;
+        for (int i = k+1; i < n; ++i) {
+            if (std::abs(a[i*n+k]) > std::abs(a[piv*n+k])) piv = i;
+        }
+        if (a[piv*n+k] == 0) return false;
+        if (piv != k) {
+            for (int j = 0; j < n; ++j) std::swap(a[k*n+j], a[piv*n+j]);
+            for (int j = 0; j < nrhs; ++j) std::swap(b[k*nrhs+j], b[piv*nrhs+j]);
+        }
+        for (int i = k+1; i < n; ++i) {
+            const Real f = a[i*n+k] / a[k*n+k];
+            for (int j = k; j < n; ++j) a[i*n+j] -= f * a[k*n+j];
+            for (int j = 0; j < nrhs; ++j) b[i*nrhs+j] -= f * b[k*nrhs+j];
+        }
+    }
+    for (int k = n-1; k >= 0; --k) {
+        for (int j = 0; j < nrhs; ++j) {
+            Real v = b[k*nrhs+j];
+            for (int i = k+1; i < n; ++i) v -= a[k*n+i] * b[i*nrhs+j];
+            b[k*nrhs+j] = v / a[k*n+k];
+        }
+    }
+    return true;
+}
+
 }
 
 MLCGSolver::MLCGSolver (MLMG* a_mlmg, MLLinOp& _lp, Type _typ)
@@ -71,6 +189,14 @@ MLCGSolver::solve (MultiFab&       sol,
 {
     if (solver_type == Type::BiCGStab) {
         return solve_bicgstab(sol,rhs,eps_rel,eps_abs);
+    } else if (solver_type == Type::PipeBiCGStab) {
+        return solve_pipebicgstab(sol,rhs,eps_rel,eps_abs);
+    } else if (solver_type == Type::PipeCG) {
+        if (sstep > 1) {
+            return solve_sstepcg(sol,rhs,eps_rel,eps_abs);
+        } else {
+            return solve_pipecg(sol,rhs,eps_rel,eps_abs);
+        }
     } else {
         return solve_cg(sol,rhs,eps_rel,eps_abs);
     }
@@ -391,6 +517,593 @@ MLCGSolver::solve_cg (MultiFab&       sol,
     return ret;
 }
 
+//
+// Pipelined BiCGStab (Cools & Vanroose, Parallel Computing 65, 2017).  The
+// recurrences carry the products A s, A z and A w along, so that both
+// reductions of an iteration are independent of the operator apply that
+// follows them and can overlap with it.
+//
+int
+MLCGSolver::solve_pipebicgstab (MultiFab&       sol,
+                                const MultiFab& rhs,
+                                Real            eps_rel,
+                                Real            eps_abs)
+{
+    BL_PROFILE("MLCGSolver::pipebicgstab");
+
+    const int ncomp = sol.nComp();
+
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+    const auto& factory = sol.Factory();
+
+    // the operator is applied to r, w and z
+    MultiFab r(ba, dm, ncomp, sol.nGrow(), MFInfo(), factory);
+    MultiFab w(ba, dm, ncomp, sol.nGrow(), MFInfo(), factory);
+    MultiFab z(ba, dm, ncomp, sol.nGrow(), MFInfo(), factory);
+    r.setVal(0.0);
+    w.setVal(0.0);
+    z.setVal(0.0);
+
+    MultiFab sorig(ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab rh   (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab p    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab s    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab t    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab v    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab q    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab y    (ba, dm, ncomp, nghost, MFInfo(), factory);
+
+    Lp.correctionResidual(amrlev, mglev, r, sol, rhs, MLLinOp::BCMode::Homogeneous);
+    Lp.normalize(amrlev, mglev, r);
+
+    MultiFab::Copy(sorig,sol,0,0,ncomp,nghost);
+    MultiFab::Copy(rh,   r,  0,0,ncomp,nghost);
+
+    Real rnorm = norm_inf(r);
+    const Real rnorm0 = rnorm;
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_PipeBiCGStab: Initial error (error0) =        " << rnorm0 << '\n';
+    }
+    int ret = 0, nit = 1;
+
+    if ( rnorm0 == 0 || rnorm0 < eps_abs )
+    {
+        if ( verbose > 0 )
+        {
+            amrex::Print() << "MLCGSolver_PipeBiCGStab: niter = 0,"
+                           << ", rnorm = " << rnorm
+                           << ", eps_abs = " << eps_abs << std::endl;
+        }
+        return ret;
+    }
+
+    sol.setVal(0);
+
+    // w = A r, t = A w
+    Lp.apply(amrlev, mglev, w, r, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+    Lp.normalize(amrlev, mglev, w);
+    Lp.apply(amrlev, mglev, t, w, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+    Lp.normalize(amrlev, mglev, t);
+
+    FusedReduce red(4, Lp.BottomCommunicator());
+    red[0] = dotxy(rh,r,true);
+    red[1] = dotxy(rh,w,true);
+    red.start();
+    red.wait();
+
+    Real rho = red[0], alpha = 0, beta = 0, omega = 0;
+    if ( rho == 0 )
+    {
+        ret = 1; nit = 0;
+    }
+    else if ( red[1] == 0 )
+    {
+        ret = 2; nit = 0;
+    }
+    else
+    {
+        alpha = rho/red[1];
+    }
+
+    for (; ret == 0 && nit <= maxiter; ++nit)
+    {
+        if ( nit == 1 )
+        {
+            MultiFab::Copy(p,r,0,0,ncomp,nghost);
+            MultiFab::Copy(s,w,0,0,ncomp,nghost);
+            MultiFab::Copy(z,t,0,0,ncomp,nghost);
+        }
+        else
+        {
+            sxay(p, p, -omega, s, nghost);
+            sxay(p, r,   beta, p, nghost);
+            sxay(s, s, -omega, z, nghost);
+            sxay(s, w,   beta, s, nghost);
+            sxay(z, z, -omega, v, nghost);
+            sxay(z, t,   beta, z, nghost);
+        }
+        sxay(q, r, -alpha, s, nghost);
+        sxay(y, w, -alpha, z, nghost);
+
+        red[0] = dotxy(q,y,true);
+        red[1] = dotxy(y,y,true);
+        red.normInf() = norm_inf(q,true);
+        red.start();
+
+        Lp.apply(amrlev, mglev, v, z, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+        Lp.normalize(amrlev, mglev, v);
+
+        red.wait();
+
+        sxay(sol, sol, alpha, p, nghost);
+
+        rnorm = red.normInf();
+
+        if ( verbose > 2 )
+        {
+            amrex::Print() << "MLCGSolver_PipeBiCGStab: Half Iter "
+                           << std::setw(11) << nit
+                           << " rel. err. "
+                           << rnorm/(rnorm0) << '\n';
+        }
+
+        if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) break;
+
+        if ( red[1] )
+        {
+            omega = red[0]/red[1];
+        }
+        else
+        {
+            ret = 3; break;
+        }
+
+        sxay(sol, sol, omega, q, nghost);
+        sxay(r,     q, -omega, y, nghost);
+        sxay(t,     t, -alpha, v, nghost);
+        sxay(w,     y, -omega, t, nghost);
+
+        red[0] = dotxy(rh,r,true);
+        red[1] = dotxy(rh,w,true);
+        red[2] = dotxy(rh,s,true);
+        red[3] = dotxy(rh,z,true);
+        red.normInf() = norm_inf(r,true);
+        red.start();
+
+        Lp.apply(amrlev, mglev, t, w, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+        Lp.normalize(amrlev, mglev, t);
+
+        red.wait();
+
+        rnorm = red.normInf();
+
+        if ( verbose > 2 )
+        {
+            amrex::Print() << "MLCGSolver_PipeBiCGStab: Iteration "
+                           << std::setw(11) << nit
+                           << " rel. err. "
+                           << rnorm/(rnorm0) << '\n';
+        }
+
+        if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) break;
+
+        if ( omega == 0 )
+        {
+            ret = 4; break;
+        }
+
+        const Real rho_1 = rho;
+        rho = red[0];
+        if ( rho == 0 )
+        {
+            ret = 1; break;
+        }
+        beta = (rho/rho_1)*(alpha/omega);
+        if ( Real den = red[1] + beta*red[2] - beta*omega*red[3] )
+        {
+            alpha = rho/den;
+        }
+        else
+        {
+            ret = 2; break;
+        }
+    }
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_PipeBiCGStab: Final: Iteration "
+                       << std::setw(4) << nit
+                       << " rel. err. "
+                       << rnorm/(rnorm0) << '\n';
+    }
+
+    if ( ret == 0 && rnorm > eps_rel*rnorm0 && rnorm > eps_abs)
+    {
+        if ( verbose > 0 && ParallelDescriptor::IOProcessor() )
+            amrex::Warning("MLCGSolver_PipeBiCGStab:: failed to converge!");
+        ret = 8;
+    }
+
+    if ( ( ret == 0 || ret == 8 ) && (rnorm < rnorm0) )
+    {
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+    else
+    {
+        sol.setVal(0);
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+
+    return ret;
+}
+
+//
+// Pipelined CG (Ghysels & Vanroose, Parallel Computing 40, 2014).  The two
+// dot products and the norm of the residual are reduced together while
+// the operator is applied to w = A r.  The norm is that of the residual
+// going into the iteration, so convergence is seen one apply late.
+//
+int
+MLCGSolver::solve_pipecg (MultiFab&       sol,
+                          const MultiFab& rhs,
+                          Real            eps_rel,
+                          Real            eps_abs)
+{
+    BL_PROFILE("MLCGSolver::pipecg");
+
+    const int ncomp = sol.nComp();
+
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+    const auto& factory = sol.Factory();
+
+    // the operator is applied to r and w
+    MultiFab r(ba, dm, ncomp, sol.nGrow(), MFInfo(), factory);
+    MultiFab w(ba, dm, ncomp, sol.nGrow(), MFInfo(), factory);
+    r.setVal(0.0);
+    w.setVal(0.0);
+
+    MultiFab sorig(ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab p    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab s    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab q    (ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab z    (ba, dm, ncomp, nghost, MFInfo(), factory);
+
+    MultiFab::Copy(sorig,sol,0,0,ncomp,nghost);
+
+    Lp.correctionResidual(amrlev, mglev, r, sol, rhs, MLLinOp::BCMode::Homogeneous);
+
+    Real       rnorm    = norm_inf(r);
+    const Real rnorm0   = rnorm;
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_PipeCG: Initial error (error0) :        " << rnorm0 << '\n';
+    }
+
+    Real gamma_1       = 0;
+    Real alpha         = 0;
+    int  ret           = 0;
+    int  nit           = 1;
+
+    if ( rnorm0 == 0 || rnorm0 < eps_abs )
+    {
+        if ( verbose > 0 ) {
+            amrex::Print() << "MLCGSolver_PipeCG: niter = 0,"
+                           << ", rnorm = " << rnorm
+                           << ", eps_abs = " << eps_abs << std::endl;
+        }
+        return ret;
+    }
+
+    sol.setVal(0);
+
+    Lp.apply(amrlev, mglev, w, r, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+
+    FusedReduce red(2, Lp.BottomCommunicator());
+
+    // the residual of the last update is checked by the next iteration
+    for (; nit <= maxiter+1; ++nit)
+    {
+        red[0] = dotxy(r,r,true);
+        red[1] = dotxy(w,r,true);
+        red.normInf() = norm_inf(r,true);
+        red.start();
+
+        if ( nit <= maxiter ) {
+            Lp.apply(amrlev, mglev, q, w, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
+        }
+
+        red.wait();
+
+        if ( nit > 1 )
+        {
+            rnorm = red.normInf();
+
+            if ( verbose > 2 )
+            {
+                amrex::Print() << "MLCGSolver_PipeCG:   Iteration"
+                               << std::setw(4) << nit-1
+                               << " rel. err. "
+                               << rnorm/(rnorm0) << '\n';
+            }
+
+            if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs || nit > maxiter ) break;
+        }
+
+        const Real gamma = red[0];
+        if ( gamma == 0 )
+        {
+            ret = 1; break;
+        }
+
+        Real beta = 0;
+        Real den = red[1];
+        if ( nit > 1 )
+        {
+            beta = gamma/gamma_1;
+            den -= beta*gamma/alpha;
+        }
+        if ( den == 0 )
+        {
+            ret = 1; break;
+        }
+        alpha = gamma/den;
+
+        if ( verbose > 2 )
+        {
+            amrex::Print() << "MLCGSolver_PipeCG:"
+                           << " nit " << nit
+                           << " gamma " << gamma
+                           << " alpha " << alpha << '\n';
+        }
+
+        if ( nit == 1 )
+        {
+            MultiFab::Copy(z,q,0,0,ncomp,nghost);
+            MultiFab::Copy(s,w,0,0,ncomp,nghost);
+            MultiFab::Copy(p,r,0,0,ncomp,nghost);
+        }
+        else
+        {
+            sxay(z, q, beta, z, nghost);
+            sxay(s, w, beta, s, nghost);
+            sxay(p, r, beta, p, nghost);
+        }
+        sxay(sol, sol,  alpha, p, nghost);
+        sxay(  r,   r, -alpha, s, nghost);
+        sxay(  w,   w, -alpha, z, nghost);
+
+        gamma_1 = gamma;
+    }
+    nit = std::min(nit-1, maxiter);
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_PipeCG: Final Iteration"
+                       << std::setw(4) << nit
+                       << " rel. err. "
+                       << rnorm/(rnorm0) << '\n';
+    }
+
+    if ( ret == 0 &&  rnorm > eps_rel*rnorm0 && rnorm > eps_abs )
+    {
+        if ( verbose > 0 && ParallelDescriptor::IOProcessor() )
+            amrex::Warning("MLCGSolver_PipeCG: failed to converge!");
+        ret = 8;
+    }
+
+    if ( ( ret == 0 || ret == 8 ) && (rnorm < rnorm0) )
+    {
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+    else
+    {
+        sol.setVal(0);
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+
+    return ret;
+}
+
+//
+// s-step CG (Chronopoulos & Gear, J. Comput. Appl. Math. 25, 1989).  Each
+// outer iteration applies the operator s times to build the scaled
+// monomial basis R_j = (A/theta)^j r, A-orthogonalizes it against the
+// previous block of directions, and takes the CG step over the whole
+// block.  All the dot products of the block, and the norm of the residual
+// going into it, share one reduction.  theta is the Rayleigh quotient of
+// the last residual, which keeps the basis vectors at a similar scale.
+//
+int
+MLCGSolver::solve_sstepcg (MultiFab&       sol,
+                           const MultiFab& rhs,
+                           Real            eps_rel,
+                           Real            eps_abs)
+{
+    BL_PROFILE("MLCGSolver::sstepcg");
+
+    const int ncomp = sol.nComp();
+    const int ns = sstep;
+
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+    const auto& factory = sol.Factory();
+
+    // R[0] is the residual; the operator is applied to R[0..ns-1]
+    Vector<MultiFab> R(ns+1);
+    Vector<MultiFab> P(ns), AP(ns), Pold(ns), APold(ns);
+    for (int j = 0; j <= ns; ++j) {
+        R[j].define(ba, dm, ncomp, sol.nGrow(), MFInfo(), factory);
+        R[j].setVal(0.0);
+    }
+    for (int j = 0; j < ns; ++j) {
+        P    [j].define(ba, dm, ncomp, nghost, MFInfo(), factory);
+        AP   [j].define(ba, dm, ncomp, nghost, MFInfo(), factory);
+        Pold [j].define(ba, dm, ncomp, nghost, MFInfo(), factory);
+        APold[j].define(ba, dm, ncomp, nghost, MFInfo(), factory);
+    }
+    MultiFab& r = R[0];
+
+    MultiFab sorig(ba, dm, ncomp, nghost, MFInfo(), factory);
+    MultiFab::Copy(sorig,sol,0,0,ncomp,nghost);
+
+    Lp.correctionResidual(amrlev, mglev, r, sol, rhs, MLLinOp::BCMode::Homogeneous);
+
+    Real       rnorm    = norm_inf(r);
+    const Real rnorm0   = rnorm;
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_SStepCG: s = " << ns
+                       << ", Initial error (error0) :        " << rnorm0 << '\n';
+    }
+
+    int ret = 0;
+    int nit = 0;
+
+    if ( rnorm0 == 0 || rnorm0 < eps_abs )
+    {
+        if ( verbose > 0 ) {
+            amrex::Print() << "MLCGSolver_SStepCG: niter = 0,"
+                           << ", rnorm = " << rnorm
+                           << ", eps_abs = " << eps_abs << std::endl;
+        }
+        return ret;
+    }
+
+    sol.setVal(0);
+
+    // C = APold^T R, D = R^T A R and g = R^T r, all ns x ns or ns, row major
+    const int nss = ns*ns;
+    FusedReduce red(2*nss+ns, Lp.BottomCommunicator());
+    Vector<Real> C(nss), D(nss), W(nss), Wold(nss), B(nss), g(ns);
+    Real theta = 1.0;
+
+    for (bool first = true; ; first = false)
+    {
+        const bool last = nit >= maxiter;
+
+        if ( !last )
+        {
+            for (int j = 1; j <= ns; ++j) {
+                Lp.apply(amrlev, mglev, R[j], R[j-1], MLLinOp::BCMode::Homogeneous,
+                         MLLinOp::StateMode::Correction);
+                if (theta != 1.0) R[j].mult(1.0/theta, 0, ncomp, nghost);
+            }
+
+            for (int i = 0; i < ns; ++i) {
+                for (int j = 0; j < ns; ++j) {
+                    red[i*ns+j] = theta * dotxy(R[i],R[j+1],true);
+                    red[nss+i*ns+j] = first ? 0.0 : dotxy(APold[i],R[j],true);
+                }
+                red[2*nss+i] = dotxy(R[i],r,true);
+            }
+        }
+        red.normInf() = norm_inf(r,true);
+        red.start();
+        red.wait();
+
+        if ( !first || last )
+        {
+            rnorm = red.normInf();
+
+            if ( verbose > 2 )
+            {
+                amrex::Print() << "MLCGSolver_SStepCG:   Iteration"
+                               << std::setw(4) << nit
+                               << " rel. err. "
+                               << rnorm/(rnorm0) << '\n';
+            }
+
+            if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs || last ) break;
+        }
+
+        std::copy(&red[0],     &red[0]+nss, D.begin());
+        std::copy(&red[nss],   &red[nss]+nss, C.begin());
+        std::copy(&red[2*nss], &red[2*nss]+ns, g.begin());
+
+        // P = R + Pold B with B = -Wold^{-1} C, and P^T A P = D + C^T B
+        W = D;
+        if ( !first )
+        {
+            for (int k = 0; k < nss; ++k) B[k] = -C[k];
+            if ( !solve_dense(Wold, B, ns, ns) )
+            {
+                ret = 1; break;
+            }
+            for (int i = 0; i < ns; ++i) {
+                for (int j = 0; j < ns; ++j) {
+                    for (int k = 0; k < ns; ++k) W[i*ns+j] += C[k*ns+i] * B[k*ns+j];
+                }
+            }
+        }
+
+        for (int j = 0; j < ns; ++j)
+        {
+            MultiFab::Copy(P[j], R[j], 0, 0, ncomp, nghost);
+            MultiFab::Copy(AP[j], R[j+1], 0, 0, ncomp, nghost);
+            AP[j].mult(theta, 0, ncomp, nghost);
+            if ( !first )
+            {
+                for (int i = 0; i < ns; ++i) {
+                    MultiFab::Saxpy(P[j], B[i*ns+j], Pold[i], 0, 0, ncomp, nghost);
+                    MultiFab::Saxpy(AP[j], B[i*ns+j], APold[i], 0, 0, ncomp, nghost);
+                }
+            }
+        }
+
+        // the step over the block: a = W^{-1} g
+        Wold = W;
+        Vector<Real> a = g;
+        if ( !solve_dense(W, a, ns, 1) )
+        {
+            ret = 1; break;
+        }
+        for (int j = 0; j < ns; ++j)
+        {
+            MultiFab::Saxpy(sol, a[j], P[j], 0, 0, ncomp, nghost);
+            MultiFab::Saxpy(r, -a[j], AP[j], 0, 0, ncomp, nghost);
+        }
+        nit += ns;
+
+        if ( ns > 1 && g[0] > 0 && g[1] > 0 ) theta *= g[1]/g[0];
+
+        std::swap(P, Pold);
+        std::swap(AP, APold);
+    }
+
+    if ( verbose > 0 )
+    {
+        amrex::Print() << "MLCGSolver_SStepCG: Final Iteration"
+                       << std::setw(4) << nit
+                       << " rel. err. "
+                       << rnorm/(rnorm0) << '\n';
+    }
+
+    if ( ret == 0 &&  rnorm > eps_rel*rnorm0 && rnorm > eps_abs )
+    {
+        if ( verbose > 0 && ParallelDescriptor::IOProcessor() )
+            amrex::Warning("MLCGSolver_SStepCG: failed to converge!");
+        ret = 8;
+    }
+
+    if ( ( ret == 0 || ret == 8 ) && (rnorm < rnorm0) )
+    {
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+    else
+    {
+        sol.setVal(0);
+        sol.plus(sorig, 0, ncomp, nghost);
+    }
+
+    return ret;
+}
+
 Real
 MLCGSolver::dotxy (const MultiFab& r, const MultiFab& z, bool local)
 {
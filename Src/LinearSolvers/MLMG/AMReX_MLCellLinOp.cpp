@@ -341,14 +341,36 @@ MLCellLinOp::smooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
                      bool skip_fillboundary) const
 {
     BL_PROFILE("MLCellLinOp::smooth()");
+    const bool overlap = info.do_overlap_smooth && supportsRegionSmooth()
+        && Gpu::notInLaunchRegion() && ParallelContext::NProcsSub() > 1;
     for (int redblack = 0; redblack < 2; ++redblack)
     {
-        applyBC(amrlev, mglev, sol, BCMode::Homogeneous, StateMode::Solution,
-                nullptr, skip_fillboundary);
+        if (overlap && !skip_fillboundary)
+        {
+            //
+            // Smooth the cells that neither need ghost cells nor are used by
+            // applyBC to fill them while the ghost cells are being exchanged.
+            //
+            const int ncomp = getNComp();
+            const IntVect nghost(std::max(1, maxorder-1));
+            sol.FillBoundary_nowait(0, ncomp, m_geom[amrlev][mglev].periodicity(), isCrossStencil());
+            FsmoothRegion(amrlev, mglev, sol, rhs, redblack, MFItInfo::InteriorCells, nghost);
+            sol.FillBoundary_finish();
+            applyBC(amrlev, mglev, sol, BCMode::Homogeneous, StateMode::Solution, nullptr, true);
 #ifdef AMREX_SOFT_PERF_COUNTERS
-        perf_counters.smooth(sol);
+            perf_counters.smooth(sol);
 #endif
-        Fsmooth(amrlev, mglev, sol, rhs, redblack);
+            FsmoothRegion(amrlev, mglev, sol, rhs, redblack, MFItInfo::HaloDependentCells, nghost);
+        }
+        else
+        {
+            applyBC(amrlev, mglev, sol, BCMode::Homogeneous, StateMode::Solution,
+                    nullptr, skip_fillboundary);
+#ifdef AMREX_SOFT_PERF_COUNTERS
+            perf_counters.smooth(sol);
+#endif
+            Fsmooth(amrlev, mglev, sol, rhs, redblack);
+        }
         skip_fillboundary = false;
     }
 }
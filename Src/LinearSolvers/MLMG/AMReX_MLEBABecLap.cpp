@@ -128,6 +128,7 @@ MLEBABecLap::~MLEBABecLap ()
 void
 MLEBABecLap::setScalars (Real a, Real b)
 {
+    if (a != m_a_scalar || b != m_b_scalar) coeffsChanged();
     m_a_scalar = a;
     m_b_scalar = b;
     if (a == 0.0)
@@ -142,26 +143,31 @@ MLEBABecLap::setScalars (Real a, Real b)
 void
 MLEBABecLap::setACoeffs (int amrlev, const MultiFab& alpha)
 {
-    MultiFab::Copy(m_a_coeffs[amrlev][0], alpha, 0, 0, 1, 0);
-    m_needs_update = true;
+    if (copyCoeffs(m_a_coeffs[amrlev][0], 0, alpha, 0, 1)) {
+        m_needs_update = true;
+    }
 }
 
 void
 MLEBABecLap::setBCoeffs (int amrlev, const Array<MultiFab const*,AMREX_SPACEDIM>& beta)
 {
     const int ncomp = getNComp();
+    bool changed = false;
     for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
         for (int icomp = 0; icomp < ncomp; ++icomp) {
-            MultiFab::Copy(m_b_coeffs[amrlev][0][idim], *beta[idim], 0, icomp, 1, 0);
+            changed = copyCoeffs(m_b_coeffs[amrlev][0][idim], icomp, *beta[idim], 0, 1) || changed;
         }
     }
-    m_needs_update = true;
+    if (changed) {
+        m_needs_update = true;
+    }
 }
 
 void
 MLEBABecLap::setEBDirichlet (int amrlev, const MultiFab& phi, const MultiFab& beta)
 {
     const int ncomp = getNComp();
+    const bool is_new = (m_eb_phi[amrlev] == nullptr || m_eb_b_coeffs[amrlev][0] == nullptr);
     if (m_eb_phi[amrlev] == nullptr) {
         const int mglev = 0;
         m_eb_phi[amrlev].reset(new MultiFab(m_grids[amrlev][mglev], m_dmap[amrlev][mglev],
@@ -179,6 +185,9 @@ MLEBABecLap::setEBDirichlet (int amrlev, const MultiFab& phi, const MultiFab& be
     auto factory = dynamic_cast<EBFArrayBoxFactory const*>(m_factory[amrlev][0].get());
     const FabArray<EBCellFlagFab>* flags = (factory) ? &(factory->getMultiEBCellFlagFab()) : nullptr;
 
+    MultiFab new_phi(m_grids[amrlev][0], m_dmap[amrlev][0], ncomp, 0, MFInfo(), *m_factory[amrlev][0]);
+    MultiFab new_beta(m_grids[amrlev][0], m_dmap[amrlev][0], ncomp, 0, MFInfo(), *m_factory[amrlev][0]);
+
     MFItInfo mfi_info;
     if (Gpu::notInLaunchRegion()) mfi_info.EnableTiling().SetDynamic(true);
 #ifdef _OPENMP
@@ -187,8 +196,8 @@ MLEBABecLap::setEBDirichlet (int amrlev, const MultiFab& phi, const MultiFab& be
     for (MFIter mfi(phi, mfi_info); mfi.isValid(); ++mfi)
     {
         const Box& bx = mfi.tilebox();
-        Array4<Real> const& phiout = m_eb_phi[amrlev]->array(mfi);
-        Array4<Real> const& betaout = m_eb_b_coeffs[amrlev][0]->array(mfi);
+        Array4<Real> const& phiout = new_phi.array(mfi);
+        Array4<Real> const& betaout = new_beta.array(mfi);
         FabType t = (flags) ? (*flags)[mfi].getType(bx) : FabType::regular;
         if (FabType::regular == t or FabType::covered == t) {
             AMREX_HOST_DEVICE_PARALLEL_FOR_4D ( bx, ncomp, i, j, k, n,
@@ -212,12 +221,15 @@ MLEBABecLap::setEBDirichlet (int amrlev, const MultiFab& phi, const MultiFab& be
             });
         }
     }
+
+    copyEBCoeffs(amrlev, new_phi, new_beta, is_new);
 }
 
 void
 MLEBABecLap::setEBHomogDirichlet (int amrlev, const MultiFab& beta)
 {
     const int ncomp = getNComp();
+    const bool is_new = (m_eb_phi[amrlev] == nullptr || m_eb_b_coeffs[amrlev][0] == nullptr);
     if (m_eb_phi[amrlev] == nullptr) {
         const int mglev = 0;
         m_eb_phi[amrlev].reset(new MultiFab(m_grids[amrlev][mglev], m_dmap[amrlev][mglev],
@@ -235,16 +247,19 @@ MLEBABecLap::setEBHomogDirichlet (int amrlev, const MultiFab& beta)
     auto factory = dynamic_cast<EBFArrayBoxFactory const*>(m_factory[amrlev][0].get());
     const FabArray<EBCellFlagFab>* flags = (factory) ? &(factory->getMultiEBCellFlagFab()) : nullptr;
 
+    MultiFab new_phi(m_grids[amrlev][0], m_dmap[amrlev][0], ncomp, 0, MFInfo(), *m_factory[amrlev][0]);
+    MultiFab new_beta(m_grids[amrlev][0], m_dmap[amrlev][0], ncomp, 0, MFInfo(), *m_factory[amrlev][0]);
+
     MFItInfo mfi_info;
     if (Gpu::notInLaunchRegion()) mfi_info.EnableTiling().SetDynamic(true);
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
-    for (MFIter mfi(*m_eb_phi[amrlev], mfi_info); mfi.isValid(); ++mfi)
+    for (MFIter mfi(new_phi, mfi_info); mfi.isValid(); ++mfi)
     {
         const Box& bx = mfi.tilebox();
-        Array4<Real> const& phifab = m_eb_phi[amrlev]->array(mfi);
-        Array4<Real> const& betaout = m_eb_b_coeffs[amrlev][0]->array(mfi);
+        Array4<Real> const& phifab = new_phi.array(mfi);
+        Array4<Real> const& betaout = new_beta.array(mfi);
         FabType t = (flags) ? (*flags)[mfi].getType(bx) : FabType::regular;
         AMREX_HOST_DEVICE_PARALLEL_FOR_4D ( bx, ncomp, i, j, k, n,
         {
@@ -268,6 +283,27 @@ MLEBABecLap::setEBHomogDirichlet (int amrlev, const MultiFab& beta)
             });
         }
     }
+
+    copyEBCoeffs(amrlev, new_phi, new_beta, is_new);
+}
+
+void
+MLEBABecLap::copyEBCoeffs (int amrlev, const MultiFab& phi, const MultiFab& beta, bool is_new)
+{
+    const int ncomp = getNComp();
+    if (is_new) {
+        // ---- there is nothing to compare with yet
+        MultiFab::Copy(*m_eb_phi[amrlev], phi, 0, 0, ncomp, 0);
+        MultiFab::Copy(*m_eb_b_coeffs[amrlev][0], beta, 0, 0, ncomp, 0);
+        coeffsChanged();
+        m_needs_update = true;
+    } else {
+        bool changed = copyCoeffs(*m_eb_phi[amrlev], 0, phi, 0, ncomp);
+        changed = copyCoeffs(*m_eb_b_coeffs[amrlev][0], 0, beta, 0, ncomp) || changed;
+        if (changed) {
+            m_needs_update = true;
+        }
+    }
 }
 
 void
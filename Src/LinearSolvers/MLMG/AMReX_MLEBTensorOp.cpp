@@ -80,7 +80,7 @@ void
 MLEBTensorOp::setBulkViscosity (int amrlev, const Array<MultiFab const*,AMREX_SPACEDIM>& kappa)
 {
     for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
-        MultiFab::Copy(m_kappa[amrlev][0][idim], *kappa[idim], 0, 0, 1, 0);
+        copyCoeffs(m_kappa[amrlev][0][idim], 0, *kappa[idim], 0, 1);
     }
     m_has_kappa = true;
 }
@@ -94,7 +94,7 @@ MLEBTensorOp::setEBShearViscosity (int amrlev, MultiFab const& eta)
 void
 MLEBTensorOp::setEBBulkViscosity (int amrlev, MultiFab const& kappa)
 {
-    MultiFab::Copy(m_eb_kappa[amrlev][0], kappa, 0, 0, 1, 0);
+    copyCoeffs(m_eb_kappa[amrlev][0], 0, kappa, 0, 1);
     m_has_eb_kappa = true;
 }
 
@@ -6,6 +6,7 @@
 #include <AMReX_Utility.H>
 #include <AMReX_MLLinOp.H>
 #include <AMReX_MLCellLinOp.H>
+#include <AMReX_MLAMGSolver.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_Machine.H>
 
@@ -499,6 +500,8 @@ MLLinOp::setDomainBC (const Array<BCType,AMREX_SPACEDIM>& a_lobc,
             }
         }
     }
+    m_setup_version = -1;
+    coeffsChanged();
 }
 
 void
@@ -537,6 +540,8 @@ MLLinOp::setDomainBC (const Vector<Array<BCType,AMREX_SPACEDIM> >& a_lobc,
             }
         }
     }
+    m_setup_version = -1;
+    coeffsChanged();
 }
 
 void
@@ -545,6 +550,30 @@ MLLinOp::setDomainBCLoc (const Array<Real,AMREX_SPACEDIM>& lo_bcloc,
 {
     m_domain_bloc_lo = lo_bcloc;
     m_domain_bloc_hi = hi_bcloc;
+    m_setup_version = -1;
+    coeffsChanged();
+}
+
+bool
+MLLinOp::copyCoeffs (MultiFab& dst, int dcomp, const MultiFab& src, int scomp, int ncomp)
+{
+    BL_PROFILE("MLLinOp::copyCoeffs()");
+
+    if (m_reuse_setup && m_setup_version >= 0)
+    {
+        MultiFab diff(dst.boxArray(), dst.DistributionMap(), ncomp, 0, MFInfo(), dst.Factory());
+        MultiFab::LinComb(diff, 1.0, dst, dcomp, -1.0, src, scomp, 0, ncomp, 0);
+        Real r = 0.0;
+        for (int n = 0; n < ncomp; ++n) {
+            r = std::max(r, diff.norm0(n, 0, true));
+        }
+        ParallelAllReduce::Max(r, m_default_comm);
+        if (r == 0.0) return false;
+    }
+
+    MultiFab::Copy(dst, src, scomp, dcomp, ncomp, 0);
+    coeffsChanged();
+    return true;
 }
 
 void
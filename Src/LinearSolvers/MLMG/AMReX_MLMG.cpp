@@ -919,12 +919,27 @@ MLMG::actualBottomSolve ()
         {
             bottomSolveWithPETSc(x, *bottom_b);
         }
+        else if (bottom_solver == BottomSolver::amg)
+        {
+            int ret = bottomSolveWithAMG(x, *bottom_b);
+            if (ret != 0) {
+                cor[amrlev][mglev]->setVal(0.0);
+            }
+            const int n = (ret==0) ? nub : nuf;
+            for (int i = 0; i < n; ++i) {
+                linop.smooth(amrlev, mglev, x, b);
+            }
+        }
         else
         {
             MLCGSolver::Type cg_type;
             if (bottom_solver == BottomSolver::cg ||
                 bottom_solver == BottomSolver::cgbicg) {
                 cg_type = MLCGSolver::Type::CG;
+            } else if (bottom_solver == BottomSolver::pipecg) {
+                cg_type = MLCGSolver::Type::PipeCG;
+            } else if (bottom_solver == BottomSolver::pipebicgstab) {
+                cg_type = MLCGSolver::Type::PipeBiCGStab;
             } else {
                 cg_type = MLCGSolver::Type::BiCGStab;
             }
@@ -970,6 +985,7 @@ MLMG::bottomSolveWithCG (MultiFab& x, const MultiFab& b, MLCGSolver::Type type)
     cg_solver.setSolver(type);
     cg_solver.setVerbose(bottom_verbose);
     cg_solver.setMaxIter(bottom_maxiter);
+    cg_solver.setSStep(bottom_sstep);
     if (cf_strategy == CFStrategy::ghostnodes) cg_solver.setNGhost(linop.getNGrow());
 
     int ret = cg_solver.solve(x, b, bottom_reltol, bottom_abstol);
@@ -979,6 +995,27 @@ MLMG::bottomSolveWithCG (MultiFab& x, const MultiFab& b, MLCGSolver::Type type)
     return ret;
 }
 
+int
+MLMG::bottomSolveWithAMG (MultiFab& x, const MultiFab& b)
+{
+    auto& amg_solver = linop.m_amg_solver;
+    const bool build = (amg_solver == nullptr);
+    if (build) {
+        amg_solver.reset(new MLAMGSolver(linop));
+    }
+    amg_solver->setVerbose(bottom_verbose);
+    amg_solver->setMaxIter(bottom_maxiter);
+    if (build) {
+        amg_solver->setup(x);
+    }
+
+    int ret = amg_solver->solve(x, b, bottom_reltol, bottom_abstol);
+    if (ret != 0 && verbose > 1) {
+        amrex::Print() << "MLMG: Bottom solve failed.\n";
+    }
+    return ret;
+}
+
 // Compute single-level masked inf-norm of Residual (res).
 Real
 MLMG::ResNormInf (int alev, bool local)
@@ -1068,6 +1105,14 @@ MLMG::buildFineMask ()
 
     if (!fine_mask.empty()) return;
 
+    if (linop.reuseSetup() && !linop.m_fine_mask.empty()) {
+        fine_mask = linop.m_fine_mask;
+        if (verbose >= 2) {
+            amrex::Print() << "MLMG: fine masks reused\n";
+        }
+        return;
+    }
+
     fine_mask.clear();
     fine_mask.resize(namrlevs);
     
@@ -1106,6 +1151,60 @@ MLMG::buildFineMask ()
             linop.fixUpResidualMask(alev, *fine_mask[alev]);
         }
     }
+
+    if (linop.reuseSetup()) {
+        linop.m_fine_mask = fine_mask;
+    }
+}
+
+bool
+MLMG::prepareLinOp ()
+{
+    bool changed = true;
+    const char* what = "prepared";
+    if (linop.reuseSetup())
+    {
+        // The setup belongs to the operator and outlives this MLMG object.
+        if (linop.m_setup_version < 0) {
+            linop.prepareForSolve();
+        } else if (linop.needsUpdate()) {
+            linop.update();
+            what = "updated";
+        } else if (linop.m_setup_version != linop.coeffsVersion()) {
+            linop.prepareForSolve();
+        } else {
+            changed = false;
+            what = "reused";
+        }
+    }
+    else if (!linop_prepared)
+    {
+        linop.prepareForSolve();
+    }
+    else if (linop.needsUpdate())
+    {
+        linop.update();
+    }
+    else
+    {
+        changed = false;
+    }
+
+    linop_prepared = true;
+
+    if (changed) {
+        linop.m_setup_version = linop.coeffsVersion();
+        linop.m_amg_solver.reset();
+    }
+
+    if (linop.reuseSetup() && verbose >= 2) {
+        amrex::Print() << "MLMG: operator setup " << what << "\n";
+        if (!changed && linop.m_amg_solver) {
+            amrex::Print() << "MLMG: AMG bottom solver setup reused\n";
+        }
+    }
+
+    return changed;
 }
 
 void
@@ -1122,23 +1221,28 @@ MLMG::prepareForSolve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab con
     int nghost = 0;
     if (cf_strategy == CFStrategy::ghostnodes) nghost = linop.getNGrow();
 
-    if (!linop_prepared) {
-        linop.prepareForSolve();
-        linop_prepared = true;
-    } else if (linop.needsUpdate()) {
-        linop.update();
-    }
+    prepareLinOp();
 
+    // In reuse mode, the bottom solvers keep their setup as long as the
+    // coefficients are those they were set up with.
+    if (!linop.reuseSetup() || bottom_setup_version != linop.coeffsVersion())
+    {
 #ifdef AMREX_USE_HYPRE
-    hypre_solver.reset();
-    hypre_bndry.reset();
-    hypre_node_solver.reset();
+        hypre_solver.reset();
+        hypre_bndry.reset();
+        hypre_node_solver.reset();
 #endif
 
 #ifdef AMREX_USE_PETSC
-    petsc_solver.reset(); 
-    petsc_bndry.reset(); 
+        petsc_solver.reset();
+        petsc_bndry.reset();
 #endif
+        bottom_setup_version = linop.coeffsVersion();
+    }
+    else if (verbose >= 2)
+    {
+        amrex::Print() << "MLMG: bottom solver setup reused\n";
+    }
 
     sol.resize(namrlevs);
     sol_raii.resize(namrlevs);
@@ -1440,12 +1544,7 @@ MLMG::compResidual (const Vector<MultiFab*>& a_res, const Vector<MultiFab*>& a_s
         }
     }
 
-    if (!linop_prepared) {
-        linop.prepareForSolve();
-        linop_prepared = true;
-    } else if (linop.needsUpdate()) {
-        linop.update();
-    }
+    prepareLinOp();
     
     const auto& amrrr = linop.AMRRefRatio();
 
@@ -1521,12 +1620,7 @@ MLMG::apply (const Vector<MultiFab*>& out, const Vector<MultiFab*>& a_in)
         rh[alev].setVal(0.0);
     }
 
-    if (!linop_prepared) {
-        linop.prepareForSolve();
-        linop_prepared = true;
-    } else if (linop.needsUpdate()) {
-        linop.update();
-    }
+    prepareLinOp();
 
     const auto& amrrr = linop.AMRRefRatio();
 
@@ -116,7 +116,7 @@ MLNodeLaplacian::define (const Vector<Geometry>& a_geom,
 void
 MLNodeLaplacian::setSigma (int amrlev, const MultiFab& a_sigma)
 {
-    MultiFab::Copy(*m_sigma[amrlev][0][0], a_sigma, 0, 0, 1, 0);
+    copyCoeffs(*m_sigma[amrlev][0][0], 0, a_sigma, 0, 1);
 }
 
 void
@@ -63,7 +63,7 @@ void
 MLTensorOp::setBulkViscosity (int amrlev, const Array<MultiFab const*,AMREX_SPACEDIM>& kappa)
 {
     for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
-        MultiFab::Copy(m_kappa[amrlev][0][idim], *kappa[idim], 0, 0, 1, 0);
+        copyCoeffs(m_kappa[amrlev][0][idim], 0, *kappa[idim], 0, 1);
     }
     m_has_kappa = true;
 }
@@ -89,6 +89,56 @@ namespace amrex {
         
         return NumSnds;
     }
+
+    long doHandShakeSparse(const std::map<int, Vector<char> >& not_ours,
+                           const Vector<int>& neighbor_procs,
+                           Vector<int>& RcvProc, Vector<long>& Rcvs)
+    {
+        BL_PROFILE("doHandShakeSparse()");
+
+        const int num_nbrs = neighbor_procs.size();
+
+        long NumSnds = 0;
+        Vector<long> nbr_snds(num_nbrs, 0);
+        Vector<long> nbr_rcvs(num_nbrs, 0);
+        for (int i = 0; i < num_nbrs; ++i)
+        {
+            auto it = not_ours.find(neighbor_procs[i]);
+            if (it != not_ours.end()) {
+                nbr_snds[i] = it->second.size();
+                NumSnds += nbr_snds[i];
+            }
+        }
+        BL_ASSERT(static_cast<int>(not_ours.size()) <= num_nbrs);
+
+        const int SeqNum = ParallelDescriptor::SeqNum();
+
+        Vector<MPI_Request> reqs(2*num_nbrs);
+        Vector<MPI_Status>  stats(2*num_nbrs);
+
+        for (int i = 0; i < num_nbrs; ++i) {
+            reqs[i] = ParallelDescriptor::Arecv(&nbr_rcvs[i], 1, neighbor_procs[i], SeqNum).req();
+        }
+
+        for (int i = 0; i < num_nbrs; ++i) {
+            reqs[num_nbrs+i] = ParallelDescriptor::Asend(&nbr_snds[i], 1, neighbor_procs[i], SeqNum).req();
+        }
+
+        if (num_nbrs > 0) {
+            ParallelDescriptor::Waitall(reqs, stats);
+        }
+
+        RcvProc.clear();
+        Rcvs.clear();
+        for (int i = 0; i < num_nbrs; ++i) {
+            if (nbr_rcvs[i] > 0) {
+                RcvProc.push_back(neighbor_procs[i]);
+                Rcvs.push_back(nbr_rcvs[i]);
+            }
+        }
+
+        return NumSnds;
+    }
 #endif  // BL_USE_MPI
 
 }
@@ -0,0 +1,200 @@
+//
+// Microbenchmark for the conversions between the IEEE 32 and 64-bit,
+// little and big-endian formats and the native float and Real formats
+// done by RealDescriptor when reading and writing FABs.
+//
+// Usage: tFabConv.ex [n=<number of reals>] [nrep=<repetitions>]
+//
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <algorithm>
+
+#include <AMReX.H>
+#include <AMReX_Print.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Random.H>
+#include <AMReX_Utility.H>
+#include <AMReX_FPC.H>
+
+using namespace amrex;
+
+namespace {
+
+struct Format
+{
+    std::string    name;
+    RealDescriptor rd;
+};
+
+bool host_is_little_endian ()
+{
+    return FPC::Native64RealDescriptor().order()[0] != 1;
+}
+
+//
+// Writes v in format rd the portable (and slow) way.
+//
+void encode (double v, const RealDescriptor& rd, char* p)
+{
+    const int nb = rd.numBytes();
+    if (nb == 4) {
+        float f = float(v);
+        std::memcpy(p, &f, 4);
+    } else {
+        std::memcpy(p, &v, 8);
+    }
+    const bool big = (rd.order()[0] == 1);
+    if (big == host_is_little_endian()) {
+        std::reverse(p, p+nb);
+    }
+}
+
+double decode (const RealDescriptor& rd, const char* p)
+{
+    const int nb = rd.numBytes();
+    char b[8];
+    std::memcpy(b, p, nb);
+    const bool big = (rd.order()[0] == 1);
+    if (big == host_is_little_endian()) {
+        std::reverse(b, b+nb);
+    }
+    if (nb == 4) {
+        float f;
+        std::memcpy(&f, b, 4);
+        return f;
+    } else {
+        double d;
+        std::memcpy(&d, b, 8);
+        return d;
+    }
+}
+
+void report (const std::string& from, const std::string& to, long n,
+             int inbytes, int outbytes, int nrep, Real t, Real err)
+{
+    const Real gbs = Real(n)*(inbytes+outbytes)*nrep / t * 1.e-9;
+    amrex::Print() << "  " << std::left << std::setw(12) << from
+                   << " -> " << std::setw(12) << to
+                   << std::right << std::setw(10) << std::setprecision(4) << gbs << " GB/s"
+                   << "   max rel. error " << std::setprecision(3) << err << "\n";
+}
+
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        long n = 4*1024*1024;
+        int nrep = 10;
+        {
+            ParmParse pp;
+            pp.query("n", n);
+            pp.query("nrep", nrep);
+        }
+
+        const Vector<Format> formats {
+            {"ieee32le", RealDescriptor(FPC::ieee_float,  FPC::reverse_float_order,  4)},
+            {"ieee32be", RealDescriptor(FPC::ieee_float,  FPC::normal_float_order,   4)},
+            {"ieee64le", RealDescriptor(FPC::ieee_double, FPC::reverse_double_order, 8)},
+            {"ieee64be", RealDescriptor(FPC::ieee_double, FPC::normal_double_order,  8)}
+        };
+
+        //
+        // Values of either sign between 1.e-3 and 1.e3, all of them exact
+        // in float so that widening can be checked exactly.
+        //
+        Vector<double> v(n);
+        for (auto& x : v) {
+            x = float((amrex::Random() < 0.5 ? -1.0 : 1.0)
+                      * std::pow(10.0, 6.0*amrex::Random()-3.0));
+        }
+
+        Vector<Real>  rbuf(n);
+        Vector<float> fbuf(n);
+        Vector<char>  cbuf(8*n);
+
+        amrex::Print() << "Converting " << n << " reals, " << nrep << " times\n"
+                       << "Bandwidth counts the bytes read plus the bytes written.\n";
+
+        amrex::Print() << "To native Real:\n";
+        for (const auto& f : formats)
+        {
+            for (long i = 0; i < n; ++i) encode(v[i], f.rd, &cbuf[i*f.rd.numBytes()]);
+            Real t = amrex::second();
+            for (int rep = 0; rep < nrep; ++rep) {
+                RealDescriptor::convertToNativeFormat(rbuf.data(), n, cbuf.data(), f.rd);
+            }
+            t = amrex::second() - t;
+            Real err = 0.0;
+            for (long i = 0; i < n; ++i) {
+                err = std::max(err, std::abs(rbuf[i]-Real(v[i]))/std::abs(v[i]));
+            }
+            report(f.name, "native Real", n, f.rd.numBytes(), sizeof(Real), nrep, t, err);
+        }
+
+        amrex::Print() << "From native Real:\n";
+        for (long i = 0; i < n; ++i) rbuf[i] = v[i];
+        for (const auto& f : formats)
+        {
+            Real t = amrex::second();
+            for (int rep = 0; rep < nrep; ++rep) {
+                RealDescriptor::convertFromNativeFormat(cbuf.data(), n, rbuf.data(), f.rd);
+            }
+            t = amrex::second() - t;
+            Real err = 0.0;
+            for (long i = 0; i < n; ++i) {
+                err = std::max(err, std::abs(decode(f.rd, &cbuf[i*f.rd.numBytes()])-v[i])/std::abs(v[i]));
+            }
+            report("native Real", f.name, n, sizeof(Real), f.rd.numBytes(), nrep, t, err);
+        }
+
+        //
+        // The native float conversions are only available through streams,
+        // so these also include the copy in and out of the stream buffer.
+        //
+        amrex::Print() << "To native float (through a stream):\n";
+        for (const auto& f : formats)
+        {
+            for (long i = 0; i < n; ++i) encode(v[i], f.rd, &cbuf[i*f.rd.numBytes()]);
+            const std::string s(cbuf.data(), n*f.rd.numBytes());
+            Real t = 0.0;
+            for (int rep = 0; rep < nrep; ++rep) {
+                std::istringstream is(s);
+                Real t0 = amrex::second();
+                RealDescriptor::convertToNativeFloatFormat(fbuf.data(), n, is, f.rd);
+                t += amrex::second() - t0;
+            }
+            Real err = 0.0;
+            for (long i = 0; i < n; ++i) {
+                err = std::max(err, std::abs(Real(fbuf[i])-Real(v[i]))/std::abs(v[i]));
+            }
+            report(f.name, "native float", n, f.rd.numBytes(), sizeof(float), nrep, t, err);
+        }
+
+        amrex::Print() << "From native float (through a stream):\n";
+        for (long i = 0; i < n; ++i) fbuf[i] = v[i];
+        for (const auto& f : formats)
+        {
+            std::string s;
+            Real t = 0.0;
+            for (int rep = 0; rep < nrep; ++rep) {
+                std::ostringstream os;
+                Real t0 = amrex::second();
+                RealDescriptor::convertFromNativeFloatFormat(os, n, fbuf.data(), f.rd);
+                t += amrex::second() - t0;
+                if (rep == nrep-1) s = os.str();
+            }
+            Real err = 0.0;
+            for (long i = 0; i < n; ++i) {
+                err = std::max(err, std::abs(decode(f.rd, &s[i*f.rd.numBytes()])-v[i])/std::abs(v[i]));
+            }
+            report("native float", f.name, n, sizeof(float), f.rd.numBytes(), nrep, t, err);
+        }
+    }
+    amrex::Finalize();
+}
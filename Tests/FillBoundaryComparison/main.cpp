@@ -132,33 +132,48 @@ main (int argc, char* argv[])
 
     Real err = 0.0;
 
-    ParallelDescriptor::Barrier();
-    Real wt0 = ParallelDescriptor::second();
-
-    for (int iround = 0; iround < nrounds; ++iround) {
-	for (int c=0; c<2; ++c) {
-	    for (int lev = 0; lev < nlevels; ++lev) {
-		mfs[lev]->FillBoundary_nowait();
-		mfs[lev]->FillBoundary_finish();
-	    }
-	    for (int lev = nlevels-1; lev >= 0; --lev) {
-		mfs[lev]->FillBoundary_nowait();
-		mfs[lev]->FillBoundary_finish();
-	    }
-	}
-	Real e = double(iround+ParallelDescriptor::MyProc());
-	ParallelDescriptor::ReduceRealMax(e);
-	err += e;
+    //
+    // Time the same sequence of FillBoundary calls with freshly posted
+    // messages and with persistent, pre-posted requests.
+    //
+    for (int persistent = 0; persistent <= 1; ++persistent)
+    {
+        FabArrayBase::use_persistent_comm = persistent;
+
+        ParallelDescriptor::Barrier();
+        Real wt0 = ParallelDescriptor::second();
+
+        for (int iround = 0; iround < nrounds; ++iround) {
+            for (int c=0; c<2; ++c) {
+                for (int lev = 0; lev < nlevels; ++lev) {
+                    mfs[lev]->FillBoundary_nowait();
+                    mfs[lev]->FillBoundary_finish();
+                }
+                for (int lev = nlevels-1; lev >= 0; --lev) {
+                    mfs[lev]->FillBoundary_nowait();
+                    mfs[lev]->FillBoundary_finish();
+                }
+            }
+            Real e = double(iround+ParallelDescriptor::MyProc());
+            ParallelDescriptor::ReduceRealMax(e);
+            err += e;
+        }
+
+        ParallelDescriptor::Barrier();
+        Real wt1 = ParallelDescriptor::second();
+
+        const long ncalls = 4L * nlevels * nrounds;
+
+        if (ParallelDescriptor::IOProcessor()) {
+            std::cout << "Using MPI" << (persistent ? " with persistent requests" : "") << std::endl;
+            std::cout << "----------------------------------------------" << std::endl;
+            std::cout << "Fill Boundary Time: " << wt1-wt0 << std::endl;
+            std::cout << "Time per call     : " << (wt1-wt0)/ncalls << std::endl;
+            std::cout << "----------------------------------------------" << std::endl;
+        }
     }
-	    
-    ParallelDescriptor::Barrier();
-    Real wt1 = ParallelDescriptor::second();
 
     if (ParallelDescriptor::IOProcessor()) {
-        std::cout << "Using MPI" << std::endl;
-	std::cout << "----------------------------------------------" << std::endl;
-	std::cout << "Fill Boundary Time: " << wt1-wt0 << std::endl;
-	std::cout << "----------------------------------------------" << std::endl;
 	std::cout << "ignore this line " << err << std::endl;
     }
 
@@ -8,6 +8,7 @@
 #include <AMReX_FArrayBox.H>
 #include <AMReX_MultiFab.H>
 #include <AMReX_VisMF.H>
+#include <AMReX_FabCompress.H>
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_Utility.H>
 #include <AMReX_NFiles.H>
@@ -199,7 +200,8 @@ void TestWriteNFiles(int nfiles, int maxgrid, int ncomps, int nboxes,
 		     VisMF::Header::Version whichVersion,
 		     bool groupSets, bool setBuf,
 		     bool useDSS, int nMultiFabs,
-		     bool checkmf, const std::string &dirName)
+		     bool checkmf, const std::string &dirName,
+		     bool asyncWrite)
 {
   VisMF::SetNOutFiles(nfiles);
   VisMF::SetGroupSets(groupSets);
@@ -252,6 +254,9 @@ void TestWriteNFiles(int nfiles, int maxgrid, int ncomps, int nboxes,
     case VisMF::Header::NoFabHeaderFAMinMax_v1:
       mfName = "TestMFNoFabHeaderFAMinMax";
     break;
+    case VisMF::Header::CompressedFab_v1:
+      mfName = "TestMFCompressed";
+    break;
     default:
       amrex::Abort("**** Error in TestWriteNFiles:  bad version.");
   }
@@ -323,10 +328,49 @@ void TestWriteNFiles(int nfiles, int maxgrid, int ncomps, int nboxes,
     cout << "------------------------------------------" << endl;
   }
 
-  for(int nmf(0); nmf < nMultiFabs; ++nmf) {
-    delete multifabs[nmf];
-  }
+  // ---- write the same data with VisMF's async path.  the time to
+  // ---- resume is how long the caller is blocked, the time to finish
+  // ---- includes waiting for the background writes.
+  Vector<std::string> asyncMFNames;
+  if(asyncWrite && whichVersion == VisMF::Header::Version_v1) {
+    asyncMFNames.resize(nMultiFabs);
+    for(int nmf(0); nmf < nMultiFabs; ++nmf) {
+      asyncMFNames[nmf] = mfNames[nmf] + "_Async";
+      VisMF::RemoveFiles(asyncMFNames[nmf], false);  // ---- not verbose
+    }
+
+    ParallelDescriptor::Barrier("TestWriteNFiles:BeforeAsyncWrite");
+    wallTimeStart = ParallelDescriptor::second();
+
+    VisMF::SetAsyncWrite(true);
+    for(int nmf(0); nmf < nMultiFabs; ++nmf) {
+      VisMF::Write(*multifabs[nmf], asyncMFNames[nmf]);
+    }
+    VisMF::SetAsyncWrite(false);
+    double resumeTime(ParallelDescriptor::second() - wallTimeStart);
+
+    long asyncBytesWritten(VisMF::FinishAsyncWrites());
+    double finishTime(ParallelDescriptor::second() - wallTimeStart);
+
+    ParallelDescriptor::Barrier("TestWriteNFiles:AfterAsyncWrite");
 
+    ParallelDescriptor::ReduceLongSum(asyncBytesWritten, ParallelDescriptor::IOProcessorNumber());
+    ParallelDescriptor::ReduceRealMax(resumeTime, ParallelDescriptor::IOProcessorNumber());
+    ParallelDescriptor::ReduceRealMax(finishTime, ParallelDescriptor::IOProcessorNumber());
+    Real asyncMegabytes((static_cast<Real> (asyncBytesWritten)) / bytesPerMB);
+
+    if(ParallelDescriptor::IOProcessor()) {
+      cout << std::setprecision(5);
+      cout << "------------------------------------------" << endl;
+      cout << "  Async write:" << endl;
+      cout << "  Total megabytes       = " << asyncMegabytes << endl;
+      cout << "  Time to resume        = " << resumeTime << " s." << endl;
+      cout << "  Time to finish        = " << finishTime << " s." << endl;
+      cout << "  Sync wall clock time  = " << wallTimeMax << " s." << endl;
+      cout << "  Resume speedup        = " << wallTimeMax/resumeTime << endl;
+      cout << "------------------------------------------" << endl;
+    }
+  }
 
   if(checkmf) {
     ParallelDescriptor::Barrier("TestWriteNFiles:checkmf");
@@ -336,6 +380,9 @@ void TestWriteNFiles(int nfiles, int maxgrid, int ncomps, int nboxes,
     for(int nmf(0); nmf < nMultiFabs; ++nmf) {
       isOk &= VisMF::Check(mfNames[nmf]);
     }
+    for(int nmf(0); nmf < asyncMFNames.size(); ++nmf) {
+      isOk &= VisMF::Check(asyncMFNames[nmf]);
+    }
     wallTimeMax = ParallelDescriptor::second() - wallTime;
     ParallelDescriptor::ReduceRealMax(wallTimeMax, ParallelDescriptor::IOProcessorNumber());
     if(ParallelDescriptor::IOProcessor()) {
@@ -349,12 +396,209 @@ void TestWriteNFiles(int nfiles, int maxgrid, int ncomps, int nboxes,
       }
       cout << "------------------------------------------" << endl;
     }
+
+    // ---- read the multifabs back with VisMF::Read and one fab at a time
+    // ---- with VisMF(name).  lossy compression may change each value by
+    // ---- up to the error bound, everything else must be exact.
+    Real tolerance(0.0);
+    if(whichVersion == VisMF::Header::CompressedFab_v1 &&
+       VisMF::GetCompressionCodec() == FabCompress::Quantize)
+    {
+      tolerance = VisMF::GetCompressionErrorBound();
+    }
+    Real maxDiff(0.0), maxFabDiff(0.0);
+    for(int nmf(0); nmf < nMultiFabs; ++nmf) {
+      MultiFab mfRead(bArray, dmap, ncomps, 0);
+      VisMF::Read(mfRead, mfNames[nmf]);
+      MultiFab::Subtract(mfRead, *multifabs[nmf], 0, 0, ncomps, 0);
+      for(int i(0); i < ncomps; ++i) {
+        maxDiff = std::max(maxDiff, mfRead.norm0(i));
+      }
+
+      VisMF vmf(mfNames[nmf]);
+      for(MFIter mfi(*multifabs[nmf]); mfi.isValid(); ++mfi) {
+        for(int i(0); i < ncomps; ++i) {
+          FArrayBox diff(vmf.GetFab(mfi.index(), i).box(), 1);
+          diff.copy(vmf.GetFab(mfi.index(), i));
+          diff.minus((*multifabs[nmf])[mfi], i, 0, 1);
+          maxFabDiff = std::max(maxFabDiff, diff.norm(0));
+          vmf.clear(mfi.index(), i);
+        }
+      }
+    }
+    ParallelDescriptor::ReduceRealMax(maxFabDiff, ParallelDescriptor::IOProcessorNumber());
+    if(ParallelDescriptor::IOProcessor()) {
+      if(maxDiff <= tolerance && maxFabDiff <= tolerance) {
+        cout << "  Read back:  multifab is ok." << endl;
+      } else {
+        cout << "**** Error:  read back:  max difference = " << maxDiff
+             << "  VisMF(name) max difference = " << maxFabDiff
+             << "  tolerance = " << tolerance << endl;
+      }
+    }
+  }
+
+  for(int nmf(0); nmf < nMultiFabs; ++nmf) {
+    delete multifabs[nmf];
   }
 
   VisMF::SetHeaderVersion(currentVersion);  // ---- set back to previous version
 }
 
 
+// -------------------------------------------------------------
+// ---- write the same MultiFabs with the static and dynamic set
+// ---- selection of NFiles and with VisMF's two-phase aggregation
+// ---- and compare the bandwidths.
+void TestWriteModes(int nfiles, int maxgrid, int ncomps, int nboxes,
+                    bool raninit, bool mb2,
+		    VisMF::Header::Version whichVersion,
+		    int nMultiFabs, bool checkmf)
+{
+  VisMF::SetNOutFiles(nfiles);
+  if(mb2) {
+    bytesPerMB = pow(2.0, 20);
+  }
+
+  BoxArray bArray(MakeBoxArray(maxgrid, nboxes));
+  DistributionMapping dmap{bArray};
+  Vector<MultiFab *> multifabs(nMultiFabs);
+  for(int nmf(0); nmf < nMultiFabs; ++nmf) {
+    multifabs[nmf] = new MultiFab(bArray, dmap, ncomps, 0);
+    for(MFIter mfiset(*(multifabs[nmf])); mfiset.isValid(); ++mfiset) {
+      for(int invar(0); invar < ncomps; ++invar) {
+        if(raninit) {
+          Real *dp = (*multifabs[nmf])[mfiset].dataPtr(invar);
+	  for(int i(0); i < (*multifabs[nmf])[mfiset].box().numPts(); ++i) {
+	    dp[i] = amrex::Random() + (1.0 + static_cast<Real> (invar));
+	  }
+        } else {
+          (*multifabs[nmf])[mfiset].setVal((100.0 * mfiset.index()) + invar +
+	                                (static_cast<Real> (nmf) / 100.0), invar);
+        }
+      }
+    }
+  }
+
+  const int nModes(3);
+  const std::string modeNames[nModes] = { "static sets", "dynamic sets", "aggregated" };
+  const std::string modeSuffixes[nModes] = { "Static", "Dynamic", "Aggregated" };
+  Real modeMBPerSec[nModes];
+
+  VisMF::Header::Version currentVersion(VisMF::GetHeaderVersion());
+  bool currentDSS(VisMF::GetUseDynamicSetSelection());
+  bool currentAggregate(VisMF::GetAggregateWrites());
+  VisMF::SetHeaderVersion(whichVersion);
+
+  if(ParallelDescriptor::IOProcessor()) {
+    cout << "  Timings for writing to " << nfiles << " files with version:  "
+         << whichVersion << endl;
+    cout << "  Aggregators per node = " << VisMF::GetAggregatorsPerNode()
+         << "  stripe size = " << VisMF::GetStripeSize() << endl;
+  }
+
+  for(int mode(0); mode < nModes; ++mode) {
+    VisMF::SetUseDynamicSetSelection(mode == 1);
+    VisMF::SetAggregateWrites(mode == 2);
+
+    Vector<std::string> mfNames(nMultiFabs);
+    for(int nmf(0); nmf < nMultiFabs; ++nmf) {
+      std::stringstream mfName;
+      mfName << "TestMFMode" << modeSuffixes[mode] << "_" << nmf;
+      mfNames[nmf] = mfName.str();
+      VisMF::RemoveFiles(mfNames[nmf], false);  // ---- not verbose
+    }
+
+    long totalBytesWritten(0);
+    ParallelDescriptor::Barrier("TestWriteModes:BeforeWrite");
+    double wallTimeStart(ParallelDescriptor::second());
+
+    for(int nmf(0); nmf < nMultiFabs; ++nmf) {
+      totalBytesWritten += VisMF::Write(*multifabs[nmf], mfNames[nmf]);
+    }
+    double wallTime(ParallelDescriptor::second() - wallTimeStart);
+
+    ParallelDescriptor::Barrier("TestWriteModes:AfterWrite");
+
+    ParallelDescriptor::ReduceLongSum(totalBytesWritten, ParallelDescriptor::IOProcessorNumber());
+    ParallelDescriptor::ReduceRealMax(wallTime, ParallelDescriptor::IOProcessorNumber());
+    Real megabytes((static_cast<Real> (totalBytesWritten)) / bytesPerMB);
+    modeMBPerSec[mode] = megabytes / wallTime;
+
+    if(ParallelDescriptor::IOProcessor()) {
+      cout << std::setprecision(5);
+      cout << "------------------------------------------" << endl;
+      cout << "  Write mode            = " << modeNames[mode] << endl;
+      cout << "  Total megabytes       = " << megabytes << endl;
+      cout << "  Write:  Megabytes/sec = " << modeMBPerSec[mode] << endl;
+      cout << "  Wall clock time       = " << wallTime << " s." << endl;
+      cout << "------------------------------------------" << endl;
+    }
+
+    if(checkmf) {
+      Real maxDiff(0.0);
+      for(int nmf(0); nmf < nMultiFabs; ++nmf) {
+        MultiFab mfRead(bArray, dmap, ncomps, 0);
+        VisMF::Read(mfRead, mfNames[nmf]);
+        MultiFab::Subtract(mfRead, *multifabs[nmf], 0, 0, ncomps, 0);
+        for(int i(0); i < ncomps; ++i) {
+          maxDiff = std::max(maxDiff, mfRead.norm0(i));
+        }
+      }
+      if(ParallelDescriptor::IOProcessor()) {
+        if(maxDiff == 0.0) {
+          cout << "  Read back:  multifab is ok." << endl;
+        } else {
+          cout << "**** Error:  read back:  max difference = " << maxDiff << endl;
+        }
+      }
+
+      // ---- RemoveFiles must find every data file, however many
+      // ---- aggregator groups wrote them
+      for(int nmf(0); nmf < nMultiFabs; ++nmf) {
+        VisMF::RemoveFiles(mfNames[nmf], false);
+      }
+      if(ParallelDescriptor::IOProcessor()) {
+        int nLeft(0);
+        for(int nmf(0); nmf < nMultiFabs; ++nmf) {
+          for(int ip(0); ip < ParallelDescriptor::NProcs(); ++ip) {
+            if(FileExists(NFilesIter::FileName(ip, mfNames[nmf] + "_D_"))) {
+              ++nLeft;
+            }
+          }
+          if(FileExists(mfNames[nmf] + "_H")) {
+            ++nLeft;
+          }
+        }
+        if(nLeft == 0) {
+          cout << "  RemoveFiles:  all files removed." << endl;
+        } else {
+          cout << "**** Error:  RemoveFiles left " << nLeft << " files." << endl;
+        }
+      }
+    }
+  }
+
+  if(ParallelDescriptor::IOProcessor()) {
+    cout << std::setprecision(5);
+    cout << "------------------------------------------" << endl;
+    for(int mode(0); mode < nModes; ++mode) {
+      cout << "  " << std::left << std::setw(14) << modeNames[mode] << std::right
+           << "  Megabytes/sec = " << std::setw(10) << modeMBPerSec[mode]
+           << "  (" << modeMBPerSec[mode] / modeMBPerSec[0] << " x static)" << endl;
+    }
+    cout << "------------------------------------------" << endl;
+  }
+
+  for(int nmf(0); nmf < nMultiFabs; ++nmf) {
+    delete multifabs[nmf];
+  }
+
+  VisMF::SetHeaderVersion(currentVersion);
+  VisMF::SetUseDynamicSetSelection(currentDSS);
+  VisMF::SetAggregateWrites(currentAggregate);
+}
+
 // -------------------------------------------------------------
 void TestReadMF(const std::string &mfName, bool useSyncReads,
                 int nMultiFabs, const std::string &dirName)
@@ -31,7 +31,11 @@ void TestWriteNFiles(int nfiles, int maxgrid, int ncomps, int nboxes,
 		     VisMF::Header::Version writeMinMax,
 		     bool groupsets, bool setbuf, bool useDSS,
 		     int nMultiFabs, bool checkmf,
-		     const std::string &dirName);
+		     const std::string &dirName, bool asyncWrite);
+void TestWriteModes(int nfiles, int maxgrid, int ncomps, int nboxes,
+                    bool raninit, bool mb2,
+		    VisMF::Header::Version writeMinMax,
+		    int nMultiFabs, bool checkmf);
 void TestReadMF(const std::string &mfName, bool useSyncReads,
                      int nMultiFabs, const std::string &dirName);
 void NFileTests(int nOutFiles, const std::string &filePrefix);
@@ -73,10 +77,40 @@ static void PrintUsage(const char *progName) {
     cout << "   [usesyncreads      = tf       ]" << '\n';
     cout << "   [nmultifabs        = nmf      ]" << '\n';
     cout << "   [dirname           = dirname  ]" << '\n';
+    cout << "   [asyncwrite        = tf       ]" << '\n';
+    cout << "   [testwritemodes    = versions ]" << '\n';
+    cout << "   [aggregatorspernode = napn    ]" << '\n';
+    cout << "   [stripesize        = nbytes   ]" << '\n';
     cout << '\n';
 }
 
 
+// -------------------------------------------------------------
+static VisMF::Header::Version IntToVersion(int iVersion) {
+    VisMF::Header::Version hVersion(VisMF::Header::Undefined_v1);
+    switch(iVersion) {
+      case 1:
+        hVersion = VisMF::Header::Version_v1;
+      break;
+      case 2:
+        hVersion = VisMF::Header::NoFabHeader_v1;
+      break;
+      case 3:
+        hVersion = VisMF::Header::NoFabHeaderMinMax_v1;
+      break;
+      case 4:
+        hVersion = VisMF::Header::NoFabHeaderFAMinMax_v1;
+      break;
+      case 5:
+        hVersion = VisMF::Header::CompressedFab_v1;
+      break;
+      default:
+        amrex::Abort("**** Error:  bad hVersion.");
+    }
+    return hVersion;
+}
+
+
 // -------------------------------------------------------------
 int main(int argc, char *argv[]) {
 
@@ -103,7 +137,10 @@ int main(int argc, char *argv[]) {
   bool checkFPositions(false), pIFStreams(false);
   bool checkmf(false);
   bool useDSS(false), useSyncReads(false);
-  Vector<int> testWriteNFilesVersions;
+  bool asyncWrite(false);
+  Vector<int> testWriteNFilesVersions, testWriteModesVersions;
+  int aggregatorsPerNode(VisMF::GetAggregatorsPerNode());
+  long stripeSize(VisMF::GetStripeSize());
   Vector<std::string> readFANames;
   int nReadStreams(1), nMultiFabs(1);
   std::string dirName("");
@@ -132,6 +169,15 @@ int main(int argc, char *argv[]) {
     pp.getarr("testwritenfiles", testWriteNFilesVersions, 0, nWNFTests);
   }
 
+  int nWMTests(pp.countval("testwritemodes"));
+  if(nWMTests > 0) {
+    pp.getarr("testwritemodes", testWriteModesVersions, 0, nWMTests);
+  }
+  pp.query("aggregatorspernode", aggregatorsPerNode);
+  aggregatorsPerNode = std::max(1, aggregatorsPerNode);
+  pp.query("stripesize", stripeSize);
+  stripeSize = std::max(1L, std::min(stripeSize, static_cast<long>(std::numeric_limits<int>::max())));
+
   pp.query("groupsets", groupSets);
   pp.query("setbuf", setBuf);
   pp.query("usesingleread", useSingleRead);
@@ -161,6 +207,7 @@ int main(int argc, char *argv[]) {
   pp.query("nreadstreams", nReadStreams);
   nReadStreams = std::max(1, nReadStreams);
   pp.query("dirname", dirName);
+  pp.query("asyncwrite", asyncWrite);
 
 
   if(ParallelDescriptor::IOProcessor()) {
@@ -198,6 +245,12 @@ int main(int argc, char *argv[]) {
     cout << "usedss            = " << useDSS << '\n';
     cout << "usesyncreads      = " << useSyncReads << '\n';
     cout << "nmultifabs        = " << nMultiFabs << '\n';
+    cout << "asyncwrite        = " << asyncWrite << '\n';
+    for(int i(0); i < testWriteModesVersions.size(); ++i) {
+      cout << "testWriteModesVersions[" << i << "]     = " << testWriteModesVersions[i] << '\n';
+    }
+    cout << "aggregatorspernode = " << aggregatorsPerNode << '\n';
+    cout << "stripesize        = " << stripeSize << '\n';
     cout << "dirName           = " << dirName << '\n';
 
     cout << '\n';
@@ -413,23 +466,7 @@ int main(int argc, char *argv[]) {
     if(ParallelDescriptor::IOProcessor()) {
       cout << "testWriteNFilesVersions[" << v << "] = " << testWriteNFilesVersions[v] << std::endl;
     }
-    VisMF::Header::Version hVersion;
-    switch(testWriteNFilesVersions[v]) {
-      case 1:
-        hVersion = VisMF::Header::Version_v1;
-      break;
-      case 2:
-        hVersion = VisMF::Header::NoFabHeader_v1;
-      break;
-      case 3:
-        hVersion = VisMF::Header::NoFabHeaderMinMax_v1;
-      break;
-      case 4:
-        hVersion = VisMF::Header::NoFabHeaderFAMinMax_v1;
-      break;
-      default:
-        amrex::Abort("**** Error:  bad hVersion.");
-      }
+    VisMF::Header::Version hVersion(IntToVersion(testWriteNFilesVersions[v]));
 
     for(int itimes(0); itimes < ntimes; ++itimes) {
       ParallelDescriptor::Barrier("TestWriteNFiles::BeforeSleep2");
@@ -443,7 +480,7 @@ int main(int argc, char *argv[]) {
 
       TestWriteNFiles(nfiles, maxgrid, ncomps, nboxes, raninit, mb2,
                       hVersion, groupSets, setBuf, useDSS, nMultiFabs,
-		      checkmf, dirName);
+		      checkmf, dirName, asyncWrite);
 
       ParallelDescriptor::Barrier("TestWriteNFiles::finished");
 
@@ -456,6 +493,39 @@ int main(int argc, char *argv[]) {
 
 
 
+  VisMF::SetAggregatorsPerNode(aggregatorsPerNode);
+  VisMF::SetStripeSize(stripeSize);
+
+  for(int v(0); v < testWriteModesVersions.size(); ++v) {
+    VisMF::Header::Version hVersion(IntToVersion(testWriteModesVersions[v]));
+    if(hVersion == VisMF::Header::CompressedFab_v1) {
+      amrex::Abort("**** Error:  testwritemodes does not support compressed fabs.");
+    }
+
+    for(int itimes(0); itimes < ntimes; ++itimes) {
+      ParallelDescriptor::Barrier("TestWriteModes::BeforeSleep2");
+      amrex::USleep(2);
+      ParallelDescriptor::Barrier("TestWriteModes::AfterSleep2");
+
+      if(ParallelDescriptor::IOProcessor()) {
+        cout << endl << "--------------------------------------------------" << endl;
+        cout << "Testing Write Modes:  version = " << hVersion << endl;
+      }
+
+      TestWriteModes(nfiles, maxgrid, ncomps, nboxes, raninit, mb2,
+                     hVersion, nMultiFabs, checkmf);
+
+      ParallelDescriptor::Barrier("TestWriteModes::finished");
+
+      if(ParallelDescriptor::IOProcessor()) {
+        cout << "==================================================" << endl;
+        cout << endl;
+      }
+    }
+  }
+
+
+
   if(testreadmf) {
     VisMF::SetMFFileInStreams(nReadStreams);
     for(int itimes(0); itimes < ntimes; ++itimes) {
@@ -0,0 +1,160 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MLMG.H>
+#include <AMReX_MLPoisson.H>
+
+using namespace amrex;
+
+//
+// Solves the same Poisson problem with each of the Krylov bottom solvers,
+// including the pipelined ones, s-step CG and AMG, and checks that they all
+// give the same solution.  The bottom level is kept large so that the
+// bottom solve dominates; the MLMG timers (verbose >= 1) and the tiny
+// profiler show the time spent in it and in its reductions.
+//
+
+namespace {
+    int n_cell = 64;
+    int max_grid_size = 32;
+    int max_coarsening_level = 3;
+    int linop_maxorder = 2;
+    Real bottom_tol = 1.e-4;
+    int bottom_verbose = 0;
+    int verbose = 1;
+    int nsolves = 1;
+}
+
+MLMG::BottomSolver
+bottom_solver_from_name (const std::string& name)
+{
+    if (name == "bicgstab") {
+        return MLMG::BottomSolver::bicgstab;
+    } else if (name == "cg") {
+        return MLMG::BottomSolver::cg;
+    } else if (name == "pipebicgstab") {
+        return MLMG::BottomSolver::pipebicgstab;
+    } else if (name == "pipecg") {
+        return MLMG::BottomSolver::pipecg;
+    } else if (name == "amg") {
+        return MLMG::BottomSolver::amg;
+    } else {
+        amrex::Abort("unknown bottom solver " + name);
+        return MLMG::BottomSolver::Default;
+    }
+}
+
+void
+solve (const Geometry& geom, MultiFab& soln, const MultiFab& rhs,
+       const std::string& name, int sstep)
+{
+    const LPInfo info = LPInfo().setMaxCoarseningLevel(max_coarsening_level);
+    MLPoisson mlpoisson({geom}, {soln.boxArray()}, {soln.DistributionMap()}, info);
+    mlpoisson.setDomainBC({AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                        LinOpBCType::Dirichlet,
+                                        LinOpBCType::Dirichlet)},
+                          {AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                        LinOpBCType::Dirichlet,
+                                        LinOpBCType::Dirichlet)});
+    mlpoisson.setLevelBC(0, nullptr);
+    // with maxorder > 2 the Dirichlet boundary stencil is not symmetric,
+    // and the CG variants no longer agree step by step
+    mlpoisson.setMaxOrder(linop_maxorder);
+
+    MLMG mlmg(mlpoisson);
+    mlmg.setVerbose(verbose);
+    mlmg.setBottomVerbose(bottom_verbose);
+    mlmg.setBottomSolver(bottom_solver_from_name(name));
+    mlmg.setBottomTolerance(bottom_tol);
+    mlmg.setBottomSStep(sstep);
+
+    Real t = 0.0;
+    for (int i = 0; i < nsolves; ++i)
+    {
+        soln.setVal(0.0);
+        ParallelDescriptor::Barrier();
+        const Real strt = ParallelDescriptor::second();
+        mlmg.solve({&soln}, {&rhs}, 1.e-10, 0.0);
+        t += ParallelDescriptor::second() - strt;
+    }
+    ParallelDescriptor::ReduceRealMax(t);
+
+    amrex::Print() << "Bottom solver " << name;
+    if (sstep > 1) amrex::Print() << " (s = " << sstep << ")";
+    amrex::Print() << ": " << t/nsolves << " s per solve\n";
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        BL_PROFILE("main()");
+
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("max_coarsening_level", max_coarsening_level);
+        pp.query("linop_maxorder", linop_maxorder);
+        pp.query("bottom_tol", bottom_tol);
+        pp.query("bottom_verbose", bottom_verbose);
+        pp.query("verbose", verbose);
+        pp.query("nsolves", nsolves);
+
+        std::vector<std::string> names {"bicgstab", "cg", "pipebicgstab", "pipecg", "amg"};
+        pp.queryarr("bottom_solvers", names);
+        std::vector<int> ssteps;
+        pp.queryarr("sstep", ssteps);
+
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+        Box domain(IntVect(0), IntVect(n_cell-1));
+        Geometry geom(domain, rb, CoordSys::cartesian, is_periodic);
+
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        MultiFab rhs(ba, dm, 1, 0);
+        const auto dx = geom.CellSizeArray();
+        for (MFIter mfi(rhs); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            auto const& a = rhs.array(mfi);
+            amrex::LoopOnCpu(bx, [=] (int i, int j, int k)
+            {
+                const Real x = (i+0.5)*dx[0];
+                const Real y = (j+0.5)*dx[1];
+                const Real z = (k+0.5)*dx[2];
+                a(i,j,k) = std::sin(M_PI*x) * std::sin(2.0*M_PI*y) * std::sin(3.0*M_PI*z)
+                    + std::exp(-100.0*((x-0.3)*(x-0.3) + (y-0.6)*(y-0.6) + (z-0.5)*(z-0.5)));
+            });
+        }
+
+        // all the solutions must agree with the first one
+        MultiFab ref(ba, dm, 1, 0);
+        MultiFab soln(ba, dm, 1, 1);
+        bool first = true;
+        auto check = [&] (const std::string& name)
+        {
+            if (first) {
+                MultiFab::Copy(ref, soln, 0, 0, 1, 0);
+                first = false;
+            } else {
+                MultiFab::Subtract(soln, ref, 0, 0, 1, 0);
+                const Real diff = soln.norm0() / ref.norm0();
+                amrex::Print() << "    relative difference from the first solution: " << diff << "\n";
+                if (diff > 1.e-8) amrex::Abort("Solution with " + name + " differs");
+            }
+        };
+
+        for (const auto& name : names) {
+            solve(geom, soln, rhs, name, 1);
+            check(name);
+        }
+        for (int s : ssteps) {
+            solve(geom, soln, rhs, "pipecg", s);
+            check("s-step CG");
+        }
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,171 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Particles.H>
+
+using namespace amrex;
+
+//
+// Measures the throughput of the operations that go through the
+// per-level tile storage: looking up tiles by (grid, tile), iterating over
+// the particles with ParIter, and Redistribute.  Build it with and without
+// USE_DENSE_PARTICLE_LEVEL to compare DenseParticleLevel with std::map.
+//
+
+struct TestParams {
+    IntVect size;
+    int max_grid_size;
+    long num_particles;
+    int nsteps;
+    int nlookups;
+};
+
+class TestParticleContainer
+    : public amrex::ParticleContainer<1+AMREX_SPACEDIM>
+{
+public:
+
+    TestParticleContainer (const Geometry& a_geom,
+                           const DistributionMapping& a_dmap,
+                           const BoxArray& a_ba)
+        : amrex::ParticleContainer<1+AMREX_SPACEDIM>(a_geom, a_dmap, a_ba)
+    {}
+
+    long lookupTiles ()
+    {
+        BL_PROFILE("lookupTiles");
+        const int lev = 0;
+        auto& plev = GetParticles(lev);
+        long np = 0;
+        for (MFIter mfi = MakeMFIter(lev); mfi.isValid(); ++mfi)
+        {
+            auto it = plev.find(std::make_pair(mfi.index(), mfi.LocalTileIndex()));
+            if (it != plev.end()) np += it->second.numParticles();
+        }
+        return np;
+    }
+
+    void moveParticles (int step)
+    {
+        BL_PROFILE("moveParticles");
+        const int lev = 0;
+        const Real* dx = Geom(lev).CellSize();
+        for (ParIter<1+AMREX_SPACEDIM> pti(*this, lev); pti.isValid(); ++pti)
+        {
+            auto& particles = pti.GetArrayOfStructs();
+            const long np = pti.numParticles();
+            for (long i = 0; i < np; ++i)
+            {
+                ParticleType& p = particles[i];
+                // a cheap, repeatable displacement of up to one cell
+                unsigned int h = static_cast<unsigned int>(p.id()) * 2654435761u
+                    + static_cast<unsigned int>(step) * 40503u;
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+                {
+                    h ^= h >> 13; h *= 0x5bd1e995u; h ^= h >> 15;
+                    p.pos(idim) += ((h & 0xffff) * (1.0/65535.0) - 0.5) * 2.0 * dx[idim];
+                }
+            }
+        }
+    }
+};
+
+void get_test_params (TestParams& params, const std::string& prefix)
+{
+    ParmParse pp(prefix);
+    pp.get("size", params.size);
+    pp.get("max_grid_size", params.max_grid_size);
+    pp.get("num_particles", params.num_particles);
+    pp.get("nsteps", params.nsteps);
+    pp.get("nlookups", params.nlookups);
+}
+
+void benchmark ()
+{
+    BL_PROFILE("benchmark");
+    TestParams params;
+    get_test_params(params, "benchmark");
+
+    int is_per[AMREX_SPACEDIM];
+    for (int i = 0; i < AMREX_SPACEDIM; i++) is_per[i] = 1;
+
+    RealBox real_box;
+    for (int n = 0; n < AMREX_SPACEDIM; n++)
+    {
+        real_box.setLo(n, 0.0);
+        real_box.setHi(n, params.size[n]);
+    }
+
+    const Box domain(IntVect::TheZeroVector(), params.size - 1);
+    Geometry geom(domain, &real_box, CoordSys::cartesian, is_per);
+
+    BoxArray ba(domain);
+    ba.maxSize(params.max_grid_size);
+    DistributionMapping dm(ba);
+
+    TestParticleContainer pc(geom, dm, ba);
+
+#ifdef AMREX_DENSE_PARTICLE_LEVEL
+    amrex::Print() << "Tile storage: DenseParticleLevel\n";
+#else
+    amrex::Print() << "Tile storage: std::map\n";
+#endif
+
+    TestParticleContainer::ParticleInitData pdata = {AMREX_D_DECL(1.0, 0.0, 0.0), 0.0};
+    pc.InitRandom(params.num_particles, 451, pdata);
+
+    const long np = pc.TotalNumberOfParticles();
+    long ntiles = 0;
+    for (MFIter mfi = pc.MakeMFIter(0); mfi.isValid(); ++mfi) ++ntiles;
+    ParallelDescriptor::ReduceLongSum(ntiles);
+    amrex::Print() << "Number of particles: " << np << ", number of tiles: " << ntiles << "\n";
+
+    Real t_lookup = 0.0, t_move = 0.0, t_redist = 0.0;
+
+    {
+        ParallelDescriptor::Barrier();
+        const Real strt = ParallelDescriptor::second();
+        long nfound = 0;
+        for (int i = 0; i < params.nlookups; ++i) nfound += pc.lookupTiles();
+        t_lookup = ParallelDescriptor::second() - strt;
+        ParallelDescriptor::ReduceLongSum(nfound);
+        AMREX_ALWAYS_ASSERT(nfound == np * params.nlookups);
+    }
+
+    for (int step = 0; step < params.nsteps; ++step)
+    {
+        ParallelDescriptor::Barrier();
+        Real strt = ParallelDescriptor::second();
+        pc.moveParticles(step);
+        t_move += ParallelDescriptor::second() - strt;
+
+        ParallelDescriptor::Barrier();
+        strt = ParallelDescriptor::second();
+        pc.Redistribute();
+        t_redist += ParallelDescriptor::second() - strt;
+    }
+
+    AMREX_ALWAYS_ASSERT(np == pc.TotalNumberOfParticles());
+
+    ParallelDescriptor::ReduceRealMax(t_lookup);
+    ParallelDescriptor::ReduceRealMax(t_move);
+    ParallelDescriptor::ReduceRealMax(t_redist);
+
+    const Real nlookups = static_cast<Real>(ntiles) * params.nlookups;
+    const Real nmoved   = static_cast<Real>(np) * params.nsteps;
+    amrex::Print() << "Tile lookup:  " << t_lookup << " s, "
+                   << (t_lookup > 0.0 ? nlookups/t_lookup : 0.0) << " tiles/s\n"
+                   << "ParIter loop: " << t_move << " s, "
+                   << (t_move > 0.0 ? nmoved/t_move : 0.0) << " particles/s\n"
+                   << "Redistribute: " << t_redist << " s, "
+                   << (t_redist > 0.0 ? nmoved/t_redist : 0.0) << " particles/s\n";
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    benchmark();
+
+    amrex::Finalize();
+}
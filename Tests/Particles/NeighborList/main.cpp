@@ -0,0 +1,238 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Particles.H>
+#include <AMReX_NeighborParticles.H>
+
+using namespace amrex;
+
+//
+// Tests and times the CPU neighbor list.  The lists are first checked
+// against a brute-force search.  The particles then drift for a number of
+// steps, once rebuilding the list every step and once with a Verlet skin,
+// and the number of interacting pairs must agree at every step.
+//
+
+struct TestParams {
+    IntVect size;
+    int max_grid_size;
+    long num_particles;
+    int nsteps;
+    Real cutoff;
+    Real skin;
+    Real max_step;
+    int do_sort;
+};
+
+struct CheckPair
+{
+    Real cutoff2;
+
+    template <class P>
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    bool operator() (const P& p1, const P& p2) const
+    {
+        Real d2 = 0.0;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            const Real d = p1.pos(idim) - p2.pos(idim);
+            d2 += d*d;
+        }
+        return d2 <= cutoff2;
+    }
+};
+
+class TestParticleContainer
+    : public NeighborParticleContainer<AMREX_SPACEDIM, 0>
+{
+public:
+
+    TestParticleContainer (const Geometry& geom, const DistributionMapping& dm,
+                           const BoxArray& ba, int ncells)
+        : NeighborParticleContainer<AMREX_SPACEDIM, 0>(geom, dm, ba, ncells)
+    {}
+
+    //! every particle moves by its own constant velocity, stored in rdata
+    void moveParticles ()
+    {
+        BL_PROFILE("moveParticles");
+        for (MyParIter pti(*this, 0); pti.isValid(); ++pti) {
+            auto& aos = pti.GetArrayOfStructs();
+            for (int i = 0; i < aos.numParticles(); ++i) {
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    aos[i].pos(idim) += aos[i].rdata(idim);
+                }
+            }
+        }
+    }
+
+    void setVelocities (Real max_step)
+    {
+        for (MyParIter pti(*this, 0); pti.isValid(); ++pti) {
+            auto& aos = pti.GetArrayOfStructs();
+            for (int i = 0; i < aos.numParticles(); ++i) {
+                // from the initial position rather than the id, so that both
+                // runs get the same velocities
+                unsigned int h = static_cast<unsigned int>(aos[i].pos(0) * 1.e6) * 2654435761u
+                    ^ static_cast<unsigned int>(aos[i].pos(AMREX_SPACEDIM-1) * 1.e6);
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    h ^= h >> 13; h *= 0x5bd1e995u; h ^= h >> 15;
+                    aos[i].rdata(idim) = ((h & 0xffff) * (1.0/65535.0) - 0.5) * 2.0 * max_step
+                        / std::sqrt(static_cast<Real>(AMREX_SPACEDIM));
+                }
+            }
+        }
+    }
+
+    //! number of listed pairs within the cutoff, as a force loop would see them
+    long countInteractions (Real cutoff)
+    {
+        BL_PROFILE("countInteractions");
+        const CheckPair within{cutoff*cutoff};
+        long count = 0;
+        for (MyParIter pti(*this, 0); pti.isValid(); ++pti) {
+            PairIndex index(pti.index(), pti.LocalTileIndex());
+            const auto& aos = pti.GetArrayOfStructs();
+            const auto& nbors = neighbors[0][index];
+            const auto& nl = neighbor_list[0][index];
+            const int np = aos.numParticles();
+            int k = 0;
+            for (int i = 0; i < np; ++i) {
+                const int nn = nl[k++];
+                for (int n = 0; n < nn; ++n) {
+                    const int j = nl[k++] - 1;
+                    const ParticleType& q = (j < np) ? aos[j] : nbors[j-np];
+                    if (within(aos[i], q)) ++count;
+                }
+            }
+        }
+        ParallelDescriptor::ReduceLongSum(count);
+        return count;
+    }
+
+    //! compares the neighbor lists with a brute-force search over each tile
+    void checkNeighborList (const CheckPair& check_pair)
+    {
+        BL_PROFILE("checkNeighborList");
+        for (MyParIter pti(*this, 0); pti.isValid(); ++pti) {
+            PairIndex index(pti.index(), pti.LocalTileIndex());
+            const auto& aos = pti.GetArrayOfStructs();
+            const auto& nbors = neighbors[0][index];
+            const auto& nl = neighbor_list[0][index];
+            const int np = aos.numParticles();
+            const int nn = nbors.size();
+            int k = 0;
+            for (int i = 0; i < np; ++i) {
+                std::vector<int> expected;
+                for (int j = 0; j < np+nn; ++j) {
+                    if (j == i) continue;
+                    const ParticleType& q = (j < np) ? aos[j] : nbors[j-np];
+                    if (check_pair(aos[i], q)) expected.push_back(j+1);
+                }
+                std::vector<int> found(nl.begin()+k+1, nl.begin()+k+1+nl[k]);
+                k += nl[k] + 1;
+                std::sort(found.begin(), found.end());
+                AMREX_ALWAYS_ASSERT(found == expected);
+            }
+        }
+    }
+};
+
+void get_test_params (TestParams& params, const std::string& prefix)
+{
+    ParmParse pp(prefix);
+    pp.get("size", params.size);
+    pp.get("max_grid_size", params.max_grid_size);
+    pp.get("num_particles", params.num_particles);
+    pp.get("nsteps", params.nsteps);
+    pp.get("cutoff", params.cutoff);
+    pp.get("skin", params.skin);
+    pp.get("max_step", params.max_step);
+    params.do_sort = 1;
+    pp.query("do_sort", params.do_sort);
+}
+
+Vector<long> run (const TestParams& params, const Geometry& geom, const BoxArray& ba,
+                  const DistributionMapping& dm, Real skin)
+{
+    // one cell of neighbors; the cells are one unit wide
+    AMREX_ALWAYS_ASSERT(params.cutoff + skin <= 1.0);
+    TestParticleContainer pc(geom, dm, ba, 1);
+    pc.setNeighborListSkin(skin);
+
+    TestParticleContainer::ParticleInitData pdata = {};
+    pc.InitRandom(params.num_particles, 451, pdata);
+    pc.setVelocities(params.max_step);
+    if (params.do_sort) pc.SortParticlesByCell();
+
+    const CheckPair check_pair{(params.cutoff + skin)*(params.cutoff + skin)};
+
+    pc.fillNeighbors();
+    pc.buildNeighborList(check_pair);
+    pc.checkNeighborList(check_pair);
+
+    Vector<long> interactions;
+    ParallelDescriptor::Barrier();
+    const Real strt = ParallelDescriptor::second();
+    for (int step = 0; step < params.nsteps; ++step)
+    {
+        pc.moveParticles();
+        if (pc.neighborListIsCurrent()) {
+            pc.updateNeighbors();
+        } else {
+            pc.RedistributeLocal();
+            if (params.do_sort) pc.SortParticlesByCell();
+            pc.fillNeighbors();
+        }
+        pc.buildNeighborList(check_pair);
+        interactions.push_back(pc.countInteractions(params.cutoff));
+    }
+    Real t = ParallelDescriptor::second() - strt;
+    ParallelDescriptor::ReduceRealMax(t);
+
+    long npairs = pc.numNeighborPairs();
+    ParallelDescriptor::ReduceLongSum(npairs);
+    amrex::Print() << "skin " << skin << ": " << t << " s for " << params.nsteps << " steps, "
+                   << pc.numNeighborListBuilds() << " builds, "
+                   << pc.numNeighborListReuses() << " reuses, "
+                   << npairs << " listed pairs, "
+                   << interactions.back() << " interacting pairs\n";
+    return interactions;
+}
+
+void test ()
+{
+    BL_PROFILE("test");
+    TestParams params;
+    get_test_params(params, "nbor_list");
+
+    int is_per[AMREX_SPACEDIM];
+    for (int i = 0; i < AMREX_SPACEDIM; i++) is_per[i] = 1;
+
+    RealBox real_box;
+    for (int n = 0; n < AMREX_SPACEDIM; n++)
+    {
+        real_box.setLo(n, 0.0);
+        real_box.setHi(n, params.size[n]);
+    }
+
+    const Box domain(IntVect::TheZeroVector(), params.size - 1);
+    Geometry geom(domain, &real_box, CoordSys::cartesian, is_per);
+
+    BoxArray ba(domain);
+    ba.maxSize(params.max_grid_size);
+    DistributionMapping dm(ba);
+
+    const Vector<long> ref = run(params, geom, ba, dm, 0.0);
+    const Vector<long> verlet = run(params, geom, ba, dm, params.skin);
+    AMREX_ALWAYS_ASSERT(ref == verlet);
+    amrex::Print() << "Interacting pairs agree at all " << params.nsteps << " steps\n";
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    test();
+
+    amrex::Finalize();
+}
@@ -0,0 +1,181 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Particles.H>
+
+using namespace amrex;
+
+//
+// Writes a particle checkpoint and restarts from it onto another BoxArray,
+// possibly on another number of ranks, once with the default per-grid
+// reads and once with particles.parallel_restart.  Checks that all the
+// particles and their data come back, and reports the restart times.
+//
+
+struct TestParams {
+    std::string mode;
+    IntVect size;
+    int max_grid_size;
+    int max_grid_size_restart;
+    long num_particles;
+    std::string dir;
+};
+
+using MyParticleContainer = ParticleContainer<2, 1, 1, 1>;
+
+struct Checksum {
+    long np = 0;
+    long idsum = 0;
+    Real weighted = 0.0;
+};
+
+Checksum checksum (MyParticleContainer& pc)
+{
+    Checksum c;
+    for (MyParticleContainer::ParIterType pti(pc, 0); pti.isValid(); ++pti)
+    {
+        const auto& aos = pti.GetArrayOfStructs();
+        const auto& soa = pti.GetStructOfArrays();
+        for (int i = 0; i < pti.numParticles(); ++i)
+        {
+            const auto& p = aos[i];
+            Real v = p.rdata(0) + 2.0*p.rdata(1) + 3.0*soa.GetRealData(0)[i]
+                + p.idata(0) + soa.GetIntData(0)[i];
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) v += p.pos(idim);
+            c.np += 1;
+            c.idsum += p.id();
+            c.weighted += (p.id() % 1000) * v;
+        }
+    }
+    ParallelDescriptor::ReduceLongSum(c.np);
+    ParallelDescriptor::ReduceLongSum(c.idsum);
+    ParallelDescriptor::ReduceRealSum(c.weighted);
+    return c;
+}
+
+void get_test_params (TestParams& params, const std::string& prefix)
+{
+    ParmParse pp(prefix);
+    params.mode = "both";
+    pp.query("mode", params.mode);
+    pp.get("size", params.size);
+    pp.get("max_grid_size", params.max_grid_size);
+    pp.get("max_grid_size_restart", params.max_grid_size_restart);
+    pp.get("num_particles", params.num_particles);
+    pp.get("dir", params.dir);
+}
+
+Geometry make_geom (const TestParams& params)
+{
+    int is_per[AMREX_SPACEDIM];
+    for (int i = 0; i < AMREX_SPACEDIM; i++) is_per[i] = 1;
+
+    RealBox real_box;
+    for (int n = 0; n < AMREX_SPACEDIM; n++)
+    {
+        real_box.setLo(n, 0.0);
+        real_box.setHi(n, 1.0);
+    }
+
+    const Box domain(IntVect::TheZeroVector(), params.size - 1);
+    return Geometry(domain, &real_box, CoordSys::cartesian, is_per);
+}
+
+void write (const TestParams& params)
+{
+    BL_PROFILE("write");
+    const Geometry geom = make_geom(params);
+    BoxArray ba(geom.Domain());
+    ba.maxSize(params.max_grid_size);
+    DistributionMapping dm(ba);
+
+    MyParticleContainer pc(geom, dm, ba);
+    MyParticleContainer::ParticleInitData pdata = {{0.0, 0.0}, {0}, {0.0}, {0}};
+    pc.InitRandom(params.num_particles, 451, pdata);
+
+    // give every particle its own data
+    for (MyParticleContainer::ParIterType pti(pc, 0); pti.isValid(); ++pti)
+    {
+        auto& aos = pti.GetArrayOfStructs();
+        auto& soa = pti.GetStructOfArrays();
+        for (int i = 0; i < pti.numParticles(); ++i)
+        {
+            auto& p = aos[i];
+            p.rdata(0) = p.pos(0) * 3.0;
+            p.rdata(1) = p.id() * 1.e-3;
+            p.idata(0) = p.id() % 7;
+            soa.GetRealData(0)[i] = p.pos(AMREX_SPACEDIM-1) - 0.5;
+            soa.GetIntData(0)[i] = p.cpu();
+        }
+    }
+
+    const Checksum c = checksum(pc);
+    ParallelDescriptor::Barrier();
+    const Real strt = ParallelDescriptor::second();
+    pc.Checkpoint(params.dir, "particles");
+    Real t = ParallelDescriptor::second() - strt;
+    ParallelDescriptor::ReduceRealMax(t);
+    amrex::Print() << "Wrote " << c.np << " particles on " << ParallelDescriptor::NProcs()
+                   << " ranks in " << t << " s\n";
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::ofstream ofs(params.dir + "/checksum");
+        ofs.precision(17);
+        ofs << c.np << " " << c.idsum << " " << c.weighted << "\n";
+    }
+    ParallelDescriptor::Barrier();
+}
+
+void read (const TestParams& params)
+{
+    BL_PROFILE("read");
+    Vector<char> chars;
+    ParallelDescriptor::ReadAndBcastFile(params.dir + "/checksum", chars);
+    std::istringstream is(std::string(chars.dataPtr()));
+    Checksum expected;
+    is >> expected.np >> expected.idsum >> expected.weighted;
+
+    const Geometry geom = make_geom(params);
+    BoxArray ba(geom.Domain());
+    ba.maxSize(params.max_grid_size_restart);
+    DistributionMapping dm(ba);
+
+    for (int parallel = 0; parallel <= 1; ++parallel)
+    {
+        ParmParse pp("particles");
+        pp.add("parallel_restart", parallel);
+
+        MyParticleContainer pc(geom, dm, ba);
+        pc.SetVerbose(2);
+
+        ParallelDescriptor::Barrier();
+        const Real strt = ParallelDescriptor::second();
+        pc.Restart(params.dir, "particles");
+        Real t = ParallelDescriptor::second() - strt;
+        ParallelDescriptor::ReduceRealMax(t);
+
+        const Checksum c = checksum(pc);
+        amrex::Print() << (parallel ? "Parallel" : "Per-grid") << " restart on "
+                       << ParallelDescriptor::NProcs() << " ranks: " << t << " s, "
+                       << c.np << " particles\n";
+        AMREX_ALWAYS_ASSERT(c.np == expected.np);
+        AMREX_ALWAYS_ASSERT(c.idsum == expected.idsum);
+        AMREX_ALWAYS_ASSERT(std::abs(c.weighted - expected.weighted)
+                            <= 1.e-10 * std::abs(expected.weighted));
+        AMREX_ALWAYS_ASSERT(pc.OK());
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        TestParams params;
+        get_test_params(params, "restart");
+
+        if (params.mode == "write" || params.mode == "both") write(params);
+        if (params.mode == "read"  || params.mode == "both") read(params);
+    }
+    amrex::Finalize();
+}
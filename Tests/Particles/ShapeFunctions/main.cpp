@@ -0,0 +1,282 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Particles.H>
+#include <AMReX_ParticleMesh.H>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace amrex;
+
+//
+// Measures the CPU particle-mesh operations with the CIC, TSC and PCS
+// shape functions, and reports particles per second per core.
+//
+// Deposition: the generic ParticleToMesh with an atomic CIC kernel, and
+// ParticleToMeshDeposit.  Mass must be conserved and both CIC results
+// must agree.
+//
+// Interpolation of AMREX_SPACEDIM components: the generic MeshToParticle
+// with a per-particle CIC functor, and MeshToParticleGather.  The mesh
+// holds linear functions, which all three shapes interpolate exactly, so
+// every result is checked against the exact values.
+//
+
+struct TestParams {
+    IntVect size;
+    int max_grid_size;
+    long num_particles;
+    int nsteps;
+    int do_sort;
+    int do_deposition;
+    int do_gather;
+};
+
+// The struct holds the mass and the values interpolated by MeshToParticle,
+// the struct-of-arrays the values interpolated by MeshToParticleGather.
+using MyParticleContainer = ParticleContainer<1+AMREX_SPACEDIM, 0, AMREX_SPACEDIM>;
+
+void get_test_params (TestParams& params, const std::string& prefix)
+{
+    ParmParse pp(prefix);
+    pp.get("size", params.size);
+    pp.get("max_grid_size", params.max_grid_size);
+    pp.get("num_particles", params.num_particles);
+    pp.get("nsteps", params.nsteps);
+    params.do_sort = 1;
+    pp.query("do_sort", params.do_sort);
+    params.do_deposition = 1;
+    pp.query("do_deposition", params.do_deposition);
+    params.do_gather = 1;
+    pp.query("do_gather", params.do_gather);
+}
+
+template <class F>
+Real timeIt (int nsteps, F&& f)
+{
+    f();  // warm up
+    ParallelDescriptor::Barrier();
+    const Real strt = ParallelDescriptor::second();
+    for (int i = 0; i < nsteps; ++i) f();
+    Real t = (ParallelDescriptor::second() - strt) / nsteps;
+    ParallelDescriptor::ReduceRealMax(t);
+    return t;
+}
+
+void report (const std::string& name, Real t, long np, int ncores, Real err)
+{
+    amrex::Print() << name << ": " << t << " s, "
+                   << (t > 0.0 ? np/t/ncores : 0.0) << " particles/s/core"
+                   << ", error " << err << "\n";
+    AMREX_ALWAYS_ASSERT(err < 1.e-10);
+}
+
+void deposition (MyParticleContainer& pc, int nsteps, Real mass, int ncores)
+{
+    BL_PROFILE("deposition");
+
+    const Geometry& geom = pc.Geom(0);
+    const BoxArray& ba = pc.ParticleBoxArray(0);
+    const DistributionMapping& dm = pc.ParticleDistributionMap(0);
+    const long np = pc.TotalNumberOfParticles();
+
+    MultiFab rho_ref(ba, dm, 1, 2);
+    MultiFab rho(ba, dm, 1, 2);
+
+    const auto plo = geom.ProbLoArray();
+    const auto dxi = geom.InvCellSizeArray();
+
+    auto mass_error = [&] (const MultiFab& mf)
+    {
+        return std::abs(mf.sum(0) - np*mass) / (np*mass);
+    };
+
+    Real t = timeIt(nsteps, [&] ()
+    {
+        amrex::ParticleToMesh(pc, rho_ref, 0,
+        [=] AMREX_GPU_DEVICE (const MyParticleContainer::ParticleType& p,
+                              amrex::Array4<amrex::Real> const& rho_arr)
+        {
+            Real wx[2], wy[2], wz[2];
+            const int i = ParticleShape<1>::weights((p.pos(0) - plo[0]) * dxi[0], wx);
+            const int j = ParticleShape<1>::weights((p.pos(1) - plo[1]) * dxi[1], wy);
+            const int k = ParticleShape<1>::weights((p.pos(2) - plo[2]) * dxi[2], wz);
+            for (int kk = 0; kk <= 1; ++kk) {
+                for (int jj = 0; jj <= 1; ++jj) {
+                    for (int ii = 0; ii <= 1; ++ii) {
+                        amrex::Gpu::Atomic::Add(&rho_arr(i+ii, j+jj, k+kk, 0),
+                                                wx[ii]*wy[jj]*wz[kk]*p.rdata(0));
+                    }
+                }
+            }
+        });
+    });
+    report("ParticleToMesh, CIC, atomic", t, np, ncores, mass_error(rho_ref));
+
+    t = timeIt(nsteps, [&] () { ParticleToMeshDeposit<1>(pc, rho, 0, 0, 0, 1); });
+    report("ParticleToMeshDeposit<1> (CIC)", t, np, ncores, mass_error(rho));
+
+    MultiFab::Subtract(rho, rho_ref, 0, 0, 1, 0);
+    const Real diff = rho.norminf(0) / rho_ref.norminf(0);
+    amrex::Print() << "  relative difference from ParticleToMesh: " << diff << "\n";
+    AMREX_ALWAYS_ASSERT(diff < 1.e-12);
+
+    t = timeIt(nsteps, [&] () { ParticleToMeshDeposit<2>(pc, rho, 0, 0, 0, 1); });
+    report("ParticleToMeshDeposit<2> (TSC)", t, np, ncores, mass_error(rho));
+
+    t = timeIt(nsteps, [&] () { ParticleToMeshDeposit<3>(pc, rho, 0, 0, 0, 1); });
+    report("ParticleToMeshDeposit<3> (PCS)", t, np, ncores, mass_error(rho));
+}
+
+AMREX_FORCE_INLINE
+Real exact (int n, const Real* x)
+{
+    Real v = 1.0 + n;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) v += (n + idim + 1) * x[idim];
+    return v;
+}
+
+void gather (MyParticleContainer& pc, int nsteps, int ncores)
+{
+    BL_PROFILE("gather");
+
+    const Geometry& geom = pc.Geom(0);
+    const BoxArray& ba = pc.ParticleBoxArray(0);
+    const DistributionMapping& dm = pc.ParticleDistributionMap(0);
+    const long np = pc.TotalNumberOfParticles();
+
+    const auto plo = geom.ProbLoArray();
+    const auto dxi = geom.InvCellSizeArray();
+    const auto dx  = geom.CellSizeArray();
+
+    // Fill the ghost cells with the linear functions too rather than with
+    // their periodic images, so that the interpolation is exact everywhere.
+    const int ncomp = AMREX_SPACEDIM;
+    MultiFab field(ba, dm, ncomp, 2);
+    for (MFIter mfi(field); mfi.isValid(); ++mfi)
+    {
+        auto arr = field.array(mfi);
+        const Box& bx = mfi.fabbox();
+        for (int n = 0; n < ncomp; ++n) {
+            for (BoxIterator bi(bx); bi.ok(); ++bi) {
+                const IntVect iv = bi();
+                Real x[AMREX_SPACEDIM];
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    x[idim] = plo[idim] + (iv[idim] + 0.5) * dx[idim];
+                }
+                arr(iv, n) = exact(n, x);
+            }
+        }
+    }
+
+    // the generic path writes struct components [1, 1+ncomp), the gather
+    // struct-of-arrays components [0, ncomp)
+    auto max_error = [&] (bool soa) -> Real
+    {
+        Real err = 0.0;
+        for (MyParticleContainer::ParIterType pti(pc, 0); pti.isValid(); ++pti)
+        {
+            const auto& aos = pti.GetArrayOfStructs();
+            const auto& soa_data = pti.GetStructOfArrays();
+            for (int i = 0; i < pti.numParticles(); ++i)
+            {
+                const auto& p = aos[i];
+                Real x[AMREX_SPACEDIM];
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) x[idim] = p.pos(idim);
+                for (int n = 0; n < ncomp; ++n) {
+                    const Real v = soa ? soa_data.GetRealData(n)[i] : p.rdata(1+n);
+                    err = std::max(err, std::abs(v - exact(n, x)));
+                }
+            }
+        }
+        ParallelDescriptor::ReduceRealMax(err);
+        return err;
+    };
+
+    Real t = timeIt(nsteps, [&] ()
+    {
+        amrex::MeshToParticle(pc, field, 0,
+        [=] AMREX_GPU_DEVICE (MyParticleContainer::ParticleType& p,
+                              amrex::Array4<const amrex::Real> const& arr)
+        {
+            Real wx[2], wy[2], wz[2];
+            const int i = ParticleShape<1>::weights((p.pos(0) - plo[0]) * dxi[0], wx);
+            const int j = ParticleShape<1>::weights((p.pos(1) - plo[1]) * dxi[1], wy);
+            const int k = ParticleShape<1>::weights((p.pos(2) - plo[2]) * dxi[2], wz);
+            for (int n = 0; n < ncomp; ++n) {
+                Real v = 0.0;
+                for (int kk = 0; kk <= 1; ++kk) {
+                    for (int jj = 0; jj <= 1; ++jj) {
+                        for (int ii = 0; ii <= 1; ++ii) {
+                            v += wx[ii]*wy[jj]*wz[kk]*arr(i+ii, j+jj, k+kk, n);
+                        }
+                    }
+                }
+                p.rdata(1+n) = v;
+            }
+        });
+    });
+    report("MeshToParticle, CIC, per particle", t, np, ncores, max_error(false));
+
+    t = timeIt(nsteps, [&] () { MeshToParticleGather<1>(pc, field, 0, 0, 0, ncomp); });
+    report("MeshToParticleGather<1> (CIC)", t, np, ncores, max_error(true));
+
+    t = timeIt(nsteps, [&] () { MeshToParticleGather<2>(pc, field, 0, 0, 0, ncomp); });
+    report("MeshToParticleGather<2> (TSC)", t, np, ncores, max_error(true));
+
+    t = timeIt(nsteps, [&] () { MeshToParticleGather<3>(pc, field, 0, 0, 0, ncomp); });
+    report("MeshToParticleGather<3> (PCS)", t, np, ncores, max_error(true));
+}
+
+void benchmark ()
+{
+    BL_PROFILE("benchmark");
+    TestParams params;
+    get_test_params(params, "benchmark");
+
+    int is_per[AMREX_SPACEDIM];
+    for (int i = 0; i < AMREX_SPACEDIM; i++) is_per[i] = 1;
+
+    RealBox real_box;
+    for (int n = 0; n < AMREX_SPACEDIM; n++)
+    {
+        real_box.setLo(n, 0.0);
+        real_box.setHi(n, 1.0);
+    }
+
+    const Box domain(IntVect::TheZeroVector(), params.size - 1);
+    Geometry geom(domain, &real_box, CoordSys::cartesian, is_per);
+
+    BoxArray ba(domain);
+    ba.maxSize(params.max_grid_size);
+    DistributionMapping dm(ba);
+
+    MyParticleContainer pc(geom, dm, ba);
+
+    const Real mass = 1.0;
+    MyParticleContainer::ParticleInitData pdata = {mass};
+    pc.InitRandom(params.num_particles, 451, pdata);
+    if (params.do_sort) pc.SortParticlesByCell();
+
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    const int ncores = ParallelDescriptor::NProcs() * nthreads;
+    amrex::Print() << "Number of particles: " << pc.TotalNumberOfParticles()
+                   << ", sorted: " << params.do_sort << ", cores: " << ncores << "\n";
+
+    if (params.do_deposition) deposition(pc, params.nsteps, mass, ncores);
+    if (params.do_gather) gather(pc, params.nsteps, ncores);
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    benchmark();
+
+    amrex::Finalize();
+}
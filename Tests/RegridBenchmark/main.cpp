@@ -0,0 +1,118 @@
+//
+// Compare the time spent in AmrMesh::MakeNewGrids with the default
+// gather-all-tags clustering and with amr.distributed_clustering, and
+// check that both give the same grids.
+//
+
+#include <AMReX.H>
+#include <AMReX_AmrMesh.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+class ShellMesh
+    : public AmrMesh
+{
+public:
+
+    ShellMesh ()
+    {
+        ParmParse pp;
+        pp.query("radius", radius);
+        pp.query("thickness", thickness);
+    }
+
+    void setDistributedClustering (bool flag) { SetDistributedClustering(flag); }
+
+    virtual void ErrorEst (int lev, TagBoxArray& tags, Real time, int ngrow) override
+    {
+        const Real* dx = Geom(lev).CellSize();
+        const Real* problo = Geom(lev).ProbLo();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(tags); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            TagBox& tagfab = tags[mfi];
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+            {
+                Real r2 = 0.0;
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    const Real x = problo[idim] + (iv[idim]+0.5)*dx[idim] - 0.5;
+                    r2 += x*x;
+                }
+                if (std::abs(std::sqrt(r2)-radius) < thickness) {
+                    tagfab(iv) = TagBox::SET;
+                }
+            }
+        }
+    }
+
+private:
+    Real radius    = 0.3;
+    Real thickness = 0.02;
+};
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        int nrounds = 10;
+        {
+            ParmParse pp;
+            pp.query("nrounds", nrounds);
+        }
+
+        ShellMesh mesh;
+
+        const BoxArray& ba = mesh.MakeBaseGrids();
+        DistributionMapping dm(ba);
+        mesh.SetBoxArray(0, ba);
+        mesh.SetDistributionMap(0, dm);
+        mesh.SetFinestLevel(0);
+
+        Vector<BoxArray> gathered_grids;
+
+        for (int distributed = 0; distributed <= 1; ++distributed)
+        {
+            mesh.setDistributedClustering(distributed);
+
+            Vector<BoxArray> new_grids(mesh.maxLevel()+1);
+            int new_finest = 0;
+
+            ParallelDescriptor::Barrier();
+            Real t0 = ParallelDescriptor::second();
+
+            for (int iround = 0; iround < nrounds; ++iround) {
+                mesh.MakeNewGrids(0, 0.0, new_finest, new_grids);
+            }
+
+            ParallelDescriptor::Barrier();
+            Real t1 = ParallelDescriptor::second() - t0;
+            ParallelDescriptor::ReduceRealMax(t1);
+
+            amrex::Print() << (distributed ? "distributed" : "gathered   ")
+                           << " clustering: " << t1/nrounds << " seconds per regrid, "
+                           << new_grids[1].size() << " boxes, "
+                           << new_grids[1].numPts() << " cells on level 1\n";
+
+            if (distributed) {
+                for (int lev = 1; lev <= new_finest; ++lev) {
+                    if (new_grids[lev] != gathered_grids[lev]) {
+                        amrex::Abort("distributed clustering gave different grids");
+                    }
+                }
+                amrex::Print() << "distributed and gathered clustering gave the same grids\n";
+            } else {
+                gathered_grids = new_grids;
+            }
+        }
+    }
+    amrex::Finalize();
+}
@@ -138,6 +138,9 @@ if ( ENABLE_PARTICLES )
       option( ENABLE_DP_PARTICLES "Enable double-precision particle data" ON )
       print_option( ENABLE_DP_PARTICLES )
    endif ()
+
+   option( ENABLE_DENSE_PARTICLE_LEVEL "Store particle tiles in a dense (grid, tile) index instead of std::map" OFF )
+   print_option( ENABLE_DENSE_PARTICLE_LEVEL )
 endif ()
 
 option( ENABLE_SENSEI_INSITU "Enable SENSEI in situ infrastructure" OFF )
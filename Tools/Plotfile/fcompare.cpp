@@ -204,9 +204,11 @@ int main_main()
                 if (grids_match) {
                     mf_b = pf_b.get(ilev, names_b[ivar_b[icomp_a]]);
                 } else {
+                    // read just the B grids under each local A grid
                     mf_b.define(mf_a.boxArray(), mf_a.DistributionMap(), 1, 0);
-                    MultiFab tmp = pf_b.get(ilev, names_b[ivar_b[icomp_a]]);
-                    mf_b.ParallelCopy(tmp);
+                    for (MFIter mfi(mf_b); mfi.isValid(); ++mfi) {
+                        pf_b.fill(mf_b[mfi], 0, ilev, names_b[ivar_b[icomp_a]]);
+                    }
                 }
                 has_nan_a[icomp_a] = mf_a.contains_nan();
                 has_nan_b[icomp_a] = mf_b.contains_nan();
@@ -326,9 +328,9 @@ int main_main()
             }
 
             for (int icomp_a = 0; icomp_a < ncomp_a; ++icomp_a) {
-                const MultiFab& mf = pf_a.get(err_zone.level,names_a[icomp_a]);
                 if (owner_proc) {
-                    Real v = mf[err_zone.grid_index](err_zone.cell);
+                    const FArrayBox& fab = pf_a.getFab(err_zone.level, err_zone.grid_index, icomp_a);
+                    Real v = fab(err_zone.cell);
                     amrex::AllPrint() << " " << std::setw(24)
                                       << names_a[icomp_a] << "  "
                                       << std::setw(24) << std::right
@@ -3,6 +3,7 @@
 #include <AMReX_PlotFileUtil.H>
 #include <AMReX_MultiFabUtil.H>
 #include <AMReX_ParallelDescriptor.H>
+#include <algorithm>
 #include <limits>
 #include <iterator>
 #include <fstream>
@@ -167,72 +168,61 @@ void main_main()
         Box slice_box(ivloc*rr,ivloc*rr);
         slice_box.setSmall(idir, std::numeric_limits<int>::lowest());
         slice_box.setBig(idir, std::numeric_limits<int>::max());
+        slice_box &= pf.probDomain(ilev);
 
         Array<Real,AMREX_SPACEDIM> dx = pf.cellSize(ilev);
 
+        IntVect ratio{1};
+        BoxArray cfba;  // fine grids coarsened to this level
         if (ilev < fine_level) {
-            IntVect ratio{pf.refRatio(ilev)};
+            ratio = IntVect{pf.refRatio(ilev)};
             for (int idim = dim; idim < AMREX_SPACEDIM; ++idim) {
                 ratio[idim] = 1;
             }
-            const iMultiFab mask = makeFineMask(pf.boxArray(ilev), pf.DistributionMap(ilev),
-                                                pf.boxArray(ilev+1), ratio);
-            for (int ivar = 0; ivar < var_names.size(); ++ivar) {
-                const MultiFab& mf = pf.get(ilev, var_names[ivar]);
-                for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
-                    const Box& bx = mfi.validbox() & slice_box;
-                    if (bx.ok()) {
-                        const auto& m = mask.array(mfi);
-                        const auto& fab = mf.array(mfi);
-                        const auto lo = amrex::lbound(bx);
-                        const auto hi = amrex::ubound(bx);
-                        for         (int k = lo.z; k <= hi.z; ++k) {
-                            for     (int j = lo.y; j <= hi.y; ++j) {
-                                for (int i = lo.x; i <= hi.x; ++i) {
-                                    if (m(i,j,k) == 0) { // not covered by fine
-                                        if (pos.size() == data[ivar].size()) {
-                                            Array<Real,AMREX_SPACEDIM> p
-                                                = {AMREX_D_DECL(problo[0]+(i+0.5)*dx[0],
-                                                                problo[1]+(j+0.5)*dx[1],
-                                                                problo[2]+(k+0.5)*dx[2])};
-                                            pos.push_back(p[idir]);
-                                        }
-                                        data[ivar].push_back(fab(i,j,k));
-                                    }
-                                }
-                            }
-                        }
-                    }
+            cfba = amrex::coarsen(pf.boxArray(ilev+1), ratio);
+        }
+
+        // only the grids crossed by the slice are read
+        const DistributionMapping& dmap = pf.DistributionMap(ilev);
+        auto isects = pf.boxArray(ilev).intersections(slice_box);
+        std::sort(isects.begin(), isects.end(),
+                  [] (std::pair<int,Box> const& a, std::pair<int,Box> const& b)
+                  { return a.first < b.first; });
+        IArrayBox mask;
+        for (auto const& is : isects) {
+            if (dmap[is.first] != ParallelDescriptor::MyProc()) continue;
+            const Box& bx = is.second;
+            mask.resize(bx,1);
+            mask.setVal(0);
+            if (!cfba.empty()) {
+                for (auto const& cis : cfba.intersections(bx)) {
+                    mask.setVal(1, cis.second, 0, 1);
                 }
             }
-            rr *= ratio;
-        } else {
+            const auto& m = mask.array();
+            const auto lo = amrex::lbound(bx);
+            const auto hi = amrex::ubound(bx);
             for (int ivar = 0; ivar < var_names.size(); ++ivar) {
-                const MultiFab& mf = pf.get(ilev, var_names[ivar]);
-                for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
-                    const Box& bx = mfi.validbox() & slice_box;
-                    if (bx.ok()) {
-                        const auto& fab = mf.array(mfi);
-                        const auto lo = amrex::lbound(bx);
-                        const auto hi = amrex::ubound(bx);
-                        for         (int k = lo.z; k <= hi.z; ++k) {
-                            for     (int j = lo.y; j <= hi.y; ++j) {
-                                for (int i = lo.x; i <= hi.x; ++i) {
-                                    if (pos.size() == data[ivar].size()) {
-                                        Array<Real,AMREX_SPACEDIM> p
-                                            = {AMREX_D_DECL(problo[0]+(i+0.5)*dx[0],
-                                                            problo[1]+(j+0.5)*dx[1],
-                                                            problo[2]+(k+0.5)*dx[2])};
-                                        pos.push_back(p[idir]);
-                                    }
-                                    data[ivar].push_back(fab(i,j,k));
+                const auto& fab = pf.getFab(ilev, is.first, var_names[ivar]).array();
+                for         (int k = lo.z; k <= hi.z; ++k) {
+                    for     (int j = lo.y; j <= hi.y; ++j) {
+                        for (int i = lo.x; i <= hi.x; ++i) {
+                            if (m(i,j,k) == 0) { // not covered by fine
+                                if (pos.size() == data[ivar].size()) {
+                                    Array<Real,AMREX_SPACEDIM> p
+                                        = {AMREX_D_DECL(problo[0]+(i+0.5)*dx[0],
+                                                        problo[1]+(j+0.5)*dx[1],
+                                                        problo[2]+(k+0.5)*dx[2])};
+                                    pos.push_back(p[idir]);
                                 }
+                                data[ivar].push_back(fab(i,j,k));
                             }
                         }
                     }
                 }
             }
         }
+        rr *= ratio;
     }
 
 #ifdef BL_USE_MPI
@@ -64,35 +64,55 @@ void main_main()
 
         const int dim = pf.spaceDim();
 
+        for (int ivar = 0; ivar < var_names.size(); ++ivar) {
+            vvmin[ivar] = std::numeric_limits<Real>::max();
+            vvmax[ivar] = std::numeric_limits<Real>::lowest();
+        }
+
         for (int ilev = pf.finestLevel(); ilev >= 0; --ilev) {
-            if (ilev == pf.finestLevel()) {
-                for (int ivar = 0; ivar < var_names.size(); ++ivar) {
-                    const MultiFab& mf = pf.get(ilev, var_names[ivar]);
-                    vvmin[ivar] = mf.min(0,0,false);
-                    vvmax[ivar] = mf.max(0,0,false);
-                }
-            } else {
+            BoxArray cfba;  // fine grids coarsened to this level
+            if (ilev < pf.finestLevel()) {
                 IntVect ratio{pf.refRatio(ilev)};
                 for (int idim = dim; idim < AMREX_SPACEDIM; ++idim) {
                     ratio[idim] = 1;
                 }
-                iMultiFab mask = makeFineMask(pf.boxArray(ilev), pf.DistributionMap(ilev),
-                                              pf.boxArray(ilev+1), ratio);
+                cfba = amrex::coarsen(pf.boxArray(ilev+1), ratio);
+            }
+            const BoxArray& ba = pf.boxArray(ilev);
+            const DistributionMapping& dmap = pf.DistributionMap(ilev);
+            IArrayBox mask;
+            for (int gid = 0; gid < ba.size(); ++gid) {
+                if (dmap[gid] != ParallelDescriptor::MyProc()) continue;
+                const Box& bx = ba[gid];
+                const auto isects = cfba.empty() ? std::vector<std::pair<int,Box> >()
+                                                 : cfba.intersections(bx);
+                if (isects.empty()) {
+                    // the FAB header min and max, if present, save the read
+                    for (int ivar = 0; ivar < var_names.size(); ++ivar) {
+                        const auto mm = pf.minMax(ilev, gid, var_names[ivar]);
+                        vvmin[ivar] = std::min(mm.first, vvmin[ivar]);
+                        vvmax[ivar] = std::max(mm.second, vvmax[ivar]);
+                    }
+                    continue;
+                } else if (cfba.contains(bx)) {
+                    continue;  // entirely covered by fine data
+                }
+                mask.resize(bx,1);
+                mask.setVal(0);
+                for (auto const& is : isects) {
+                    mask.setVal(1, is.second, 0, 1);
+                }
+                const auto lo = amrex::lbound(bx);
+                const auto hi = amrex::ubound(bx);
+                const auto& ifab = mask.array();
                 for (int ivar = 0; ivar < var_names.size(); ++ivar) {
-                    const MultiFab& mf = pf.get(ilev, var_names[ivar]);
-                    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
-                        const Box& bx = mfi.validbox();
-                        const auto lo = amrex::lbound(bx);
-                        const auto hi = amrex::ubound(bx);
-                        const auto& ifab = mask.array(mfi);
-                        const auto& fab = mf.array(mfi);
-                        for         (int k = lo.z; k <= hi.z; ++k) {
-                            for     (int j = lo.y; j <= hi.y; ++j) {
-                                for (int i = lo.x; i <= hi.x; ++i) {
-                                    if (ifab(i,j,k) == 0) {
-                                        vvmin[ivar] = std::min(fab(i,j,k),vvmin[ivar]);
-                                        vvmax[ivar] = std::max(fab(i,j,k),vvmax[ivar]);
-                                    }
+                    const auto& fab = pf.getFab(ilev, gid, var_names[ivar]).array();
+                    for         (int k = lo.z; k <= hi.z; ++k) {
+                        for     (int j = lo.y; j <= hi.y; ++j) {
+                            for (int i = lo.x; i <= hi.x; ++i) {
+                                if (ifab(i,j,k) == 0) {
+                                    vvmin[ivar] = std::min(fab(i,j,k),vvmin[ivar]);
+                                    vvmax[ivar] = std::max(fab(i,j,k),vvmax[ivar]);
                                 }
                             }
                         }
@@ -197,63 +197,59 @@ void main_main()
     Real gmn = std::numeric_limits<Real>::max();
 
     for (int ilev = 0; ilev <= max_level; ++ilev) {
-        const MultiFab& pltmf = pf.get(ilev, compname);
-        gmx = std::max(gmx, pltmf.max(0));
-        gmn = std::min(gmn, pltmf.min(0));
+        // the min and max usually come from the FAB headers, so only the
+        // grids crossed by the slices are read
+        const auto mm = pf.minMax(ilev, compname);
+        gmn = std::min(gmn, mm.first);
+        gmx = std::max(gmx, mm.second);
+
+        BoxArray cfba;  // fine grids coarsened to this level
         if (ilev < max_level) {
             IntVect ratio{pf.refRatio(ilev)};
             for (int idim = dim; idim < AMREX_SPACEDIM; ++idim) {
                 ratio[idim] = 1;
             }
-            const iMultiFab mask = makeFineMask(pltmf, pf.boxArray(ilev+1), ratio);
-            for (MFIter mfi(pltmf); mfi.isValid(); ++mfi) {
-                const auto& m = mask.array(mfi);
-                const auto& plt = pltmf.array(mfi);
-                const Box& bx = mfi.validbox();
-                IntVect rrlev {rr[ilev]};
-                for (int idim = dim; idim < AMREX_SPACEDIM; ++idim) {
-                    rrlev[idim] = 1;
+            cfba = amrex::coarsen(pf.boxArray(ilev+1), ratio);
+        }
+        IntVect rrlev {rr[ilev]};
+        for (int idim = dim; idim < AMREX_SPACEDIM; ++idim) {
+            rrlev[idim] = 1;
+        }
+
+        IArrayBox mask;
+        for (int idir = ndir_begin; idir < ndir_end; ++idir) {
+            const Box& crsebox = amrex::coarsen(finebox[idir], rrlev);
+            const auto& data = datamf[idir].array(0); // there is only one box
+            IntVect rrslice = rrlev;
+            rrslice[idir] = 1;
+            const int islice = iloc[idir];
+            for (auto const& is : pf.boxArray(ilev).intersections(crsebox)) {
+                const Box& ibox = is.second;
+                mask.resize(ibox,1);
+                mask.setVal(0);
+                if (!cfba.empty()) {
+                    for (auto const& cis : cfba.intersections(ibox)) {
+                        mask.setVal(1, cis.second, 0, 1);
+                    }
                 }
-                for (int idir = ndir_begin; idir < ndir_end; ++idir) {
-                    const Box& crsebox = amrex::coarsen(finebox[idir], rrlev);
-                    const Box& ibox = bx & crsebox;
-                    if (ibox.ok()) {
-                        const auto& data = datamf[idir].array(0); // there is only one box
-                        IntVect rrslice = rrlev;
-                        rrslice[idir] = 1;
-                        amrex::For(ibox, [=] (int i, int j, int k)
-                        {
-                            if (m(i,j,k) == 0) { // not covered by fine
-                                const Real d = plt(i,j,k);
-                                for         (int koff = 0; koff < rrslice[2]; ++koff) {
-                                    int kk = k*rrlev[2] + koff;
-                                    for     (int joff = 0; joff < rrslice[1]; ++joff) {
-                                        int jj = j*rrlev[1] + joff;
-                                        for (int ioff = 0; ioff < rrslice[0]; ++ioff) {
-                                            int ii = i*rrlev[0] + ioff;
-                                            data(ii,jj,kk) = d;
-                                        }
-                                    }
+                const auto& m = mask.array();
+                const auto& plt = pf.getFab(ilev, is.first, compname).array();
+                amrex::For(ibox, [=] (int i, int j, int k)
+                {
+                    if (m(i,j,k) == 0) { // not covered by fine
+                        const Real d = plt(i,j,k);
+                        for         (int koff = 0; koff < rrslice[2]; ++koff) {
+                            int kk = (idir == 2) ? islice : k*rrlev[2] + koff;
+                            for     (int joff = 0; joff < rrslice[1]; ++joff) {
+                                int jj = (idir == 1) ? islice : j*rrlev[1] + joff;
+                                for (int ioff = 0; ioff < rrslice[0]; ++ioff) {
+                                    int ii = (idir == 0) ? islice : i*rrlev[0] + ioff;
+                                    data(ii,jj,kk) = d;
                                 }
                             }
-                        });
+                        }
                     }
-                }
-            }
-        } else {
-            for (MFIter mfi(pltmf); mfi.isValid(); ++mfi) {
-                const auto& plt = pltmf.array(mfi);
-                const Box& bx = mfi.validbox();
-                for (int idir = ndir_begin; idir < ndir_end; ++idir) {
-                    const Box& ibox = bx & finebox[idir];
-                    if (ibox.ok()) {
-                        const auto& data = datamf[idir].array(0); // there is only one box
-                        amrex::ParallelFor(ibox, [=] (int i, int j, int k)
-                        {
-                            data(i,j,k) = plt(i,j,k);
-                        });
-                    }
-                }
+                });
             }
         }
     }
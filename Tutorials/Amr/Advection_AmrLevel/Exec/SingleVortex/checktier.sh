@@ -0,0 +1,42 @@
+#!/bin/bash
+#
+# Restart from the node-local checkpoint tier (amr.check_local_dir) on
+# one machine.  Every rank gets its own directory under tier/local, and
+# amr.check_local_buddy=1 makes each rank keep a copy of the previous
+# rank's files.  After the checkpoint at step 4 the shared copy and the
+# local directory of rank 1 are deleted, as if the run had died before
+# the drain finished.  The restart must restore chk00004 from the tier
+# and give the same plotfile and particles as a restart from an ordinary
+# checkpoint (restarts may reorder particles, so particle_compare needs
+# both runs to restart).
+#
+# usage: checktier.sh executable [fcompare] [particle_compare]
+#
+
+EXE=$(readlink -f ${1:?"usage: checktier.sh executable [fcompare] [particle_compare]"})
+FCOMPARE=${2:-fcompare}
+PCOMPARE=${3:-particle_compare}
+MPIRUN=${MPIRUN:-"mpiexec -n 4"}
+INPUTS=$(readlink -f inputs.checktier)
+PROBIN=$(readlink -f probin)
+
+set -e
+
+rm -rf ref tier
+mkdir ref tier
+
+cd ref
+${MPIRUN} ${EXE} ${INPUTS} amr.probin_file=${PROBIN} max_step=4 > log
+${MPIRUN} ${EXE} ${INPUTS} amr.probin_file=${PROBIN} amr.restart=chk00004 > log.restart
+cd ..
+
+cd tier
+TIER="amr.check_local_dir=$(pwd)/local amr.check_local_buddy=1"
+${MPIRUN} ${EXE} ${INPUTS} amr.probin_file=${PROBIN} ${TIER} max_step=4 > log
+rm -rf chk00004 local/rank_00001
+${MPIRUN} ${EXE} ${INPUTS} amr.probin_file=${PROBIN} ${TIER} amr.restart=chk00004 > log.restart
+grep "restored chk00004 from the local checkpoint tier" log.restart
+cd ..
+
+${FCOMPARE} ref/plt00008 tier/plt00008
+${PCOMPARE} ref/plt00008 tier/plt00008 Tracer
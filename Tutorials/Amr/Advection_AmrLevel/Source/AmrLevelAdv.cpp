@@ -292,6 +292,8 @@ AmrLevelAdv::advance (Real time,
 
 	for (MFIter mfi(S_new, true); mfi.isValid(); ++mfi)
 	{
+	    MFIterCostTimer timer(&getCosts(), mfi);
+
 	    const Box& bx = mfi.tilebox();
 
 	    const FArrayBox& statein = Sborder[mfi];